@@ -60,6 +60,9 @@ func main() {
         if err != nil {
             log.Fatalf("Failed to NewMetricUpdater: %v", err)
         }
+        if err := export.Handle(exporter.SoftirqOutlierHTTPPath, metricsUpdater.SoftirqOutlierHandler()); err != nil {
+            log.Printf("Failed to register softirq outlier endpoint: %v", err)
+        }
 
         for {
             select {
@@ -76,6 +79,21 @@ func main() {
                 if err := metricsUpdater.UpdateTcpStatMetrics(); err != nil {
                     log.Printf("Failed to update TCP metrics: ", err)
                 }
+                if err := metricsUpdater.UpdateTcpRetransMetrics(); err != nil {
+                    log.Printf("Failed to update TCP retransmit metrics: %v", err)
+                }
+                if err := metricsUpdater.UpdateRunqlatMetrics(); err != nil {
+                    log.Printf("Failed to update run queue latency metrics: %v", err)
+                }
+                if err := metricsUpdater.UpdateBlockIOMetrics(); err != nil {
+                    log.Printf("Failed to update block I/O metrics: %v", err)
+                }
+                if err := metricsUpdater.UpdateMemStallMetrics(); err != nil {
+                    log.Printf("Failed to update memory stall metrics: %v", err)
+                }
+                if err := metricsUpdater.UpdatePlainMetrics(); err != nil {
+                    log.Printf("Failed to update plain metrics: %v", err)
+                }
             }
         }
     }()
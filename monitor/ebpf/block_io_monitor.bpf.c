@@ -0,0 +1,189 @@
+// 块设备 I/O 延迟与下发时的队列深度，按设备和请求类型统计
+#include "vmlinux.h"
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_tracing.h>
+#include <bpf/bpf_core_read.h>
+#include "block_io_monitor.h"
+#include "bpf_common.h"
+
+char LICENSE[] SEC("license") = "GPL";
+
+#define REQ_OP_MASK 0xff
+#define MINORBITS 20
+
+extern int LINUX_KERNEL_VERSION __kconfig;
+
+// 下发时记录，完成或重新排队时删除
+struct block_req {
+    u64 ts;
+    u32 dev;
+    u32 op;
+};
+
+// 键为 struct request 的地址
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, BLOCK_START_ENTRIES);
+    __type(key, u64);
+    __type(value, struct block_req);
+} block_start SEC(".maps");
+
+// 每个设备的在途请求数（只计被跟踪的请求），各 CPU 共享，原子增减
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, BLOCK_MAX_DEVICES);
+    __type(key, u32);
+    __type(value, u64);
+} block_inflight SEC(".maps");
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_HASH);
+    __uint(max_entries, BLOCK_MAX_DEVICES * BLOCK_OPS);
+    __type(key, struct block_hist_key);
+    __type(value, struct block_hist);
+} block_hist SEC(".maps");
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, BLOCK_STAT_COUNTERS);
+    __type(key, u32);
+    __type(value, u64);
+} block_counters SEC(".maps");
+
+// 5.17 之前请求直接指向所属磁盘
+struct request___pre_517 {
+    struct gendisk *rq_disk;
+} __attribute__((preserve_access_index));
+
+static __always_inline u32 request_dev(struct request *rq)
+{
+    struct request___pre_517 *old = (void *)rq;
+    struct gendisk *disk;
+
+    if (bpf_core_field_exists(old->rq_disk))
+        disk = BPF_CORE_READ(old, rq_disk);
+    else
+        disk = BPF_CORE_READ(rq, q, disk);
+    if (!disk)
+        return 0;
+    return (u32)BPF_CORE_READ(disk, major) << MINORBITS | (u32)BPF_CORE_READ(disk, first_minor);
+}
+
+static __always_inline u32 request_op(struct request *rq)
+{
+    u32 op = BPF_CORE_READ(rq, cmd_flags) & REQ_OP_MASK;
+
+    return op < BLOCK_OP_OTHER ? op : BLOCK_OP_OTHER;
+}
+
+// 查找或插入本 CPU 上 (dev, op) 的直方图，表满时计入 BLOCK_STAT_HIST_DROPS
+static __always_inline struct block_hist *hist_of(u32 dev, u32 op)
+{
+    struct block_hist_key key = { .dev = dev, .op = op };
+    struct block_hist *hist, zero = {};
+
+    hist = lookup_or_try_init(&block_hist, &key, &zero);
+    if (!hist)
+        count_event(&block_counters, BLOCK_STAT_HIST_DROPS);
+    return hist;
+}
+
+// 设备的在途请求数加 delta，返回加之后的值
+static __always_inline u64 inflight_add(u32 dev, s64 delta)
+{
+    u64 *inflight, zero = 0;
+
+    inflight = lookup_or_try_init(&block_inflight, &dev, &zero);
+    if (!inflight)
+        return 0;
+    return __sync_fetch_and_add(inflight, delta) + delta;
+}
+
+static __always_inline int trace_issue(struct request *rq)
+{
+    struct block_req start;
+    struct block_hist *hist;
+    u64 key = (u64)rq, depth;
+    u32 slot;
+
+    start.dev = request_dev(rq);
+    if (!start.dev)
+        return 0;
+    start.op = request_op(rq);
+    start.ts = bpf_ktime_get_ns();
+    if (bpf_map_update_elem(&block_start, &key, &start, BPF_ANY) != 0) {
+        count_event(&block_counters, BLOCK_STAT_START_DROPS);
+        return 0;
+    }
+
+    depth = inflight_add(start.dev, 1);
+    hist = hist_of(start.dev, start.op);
+    if (!hist || !depth)
+        return 0;
+    slot = log2_u64(depth);
+    if (slot >= BLOCK_DEPTH_SLOTS)
+        slot = BLOCK_DEPTH_SLOTS - 1;
+    hist->depth_slots[slot]++;
+    hist->depth_sum += depth;
+    return 0;
+}
+
+// 完成或重新排队：结束对请求的跟踪，返回 0 表示请求没有被跟踪
+static __always_inline int finish(struct request *rq, struct block_req *out)
+{
+    struct block_req *start;
+    u64 key = (u64)rq;
+
+    start = bpf_map_lookup_elem(&block_start, &key);
+    if (!start)
+        return 0;
+    *out = *start;
+    bpf_map_delete_elem(&block_start, &key);
+    inflight_add(out->dev, -1);
+    return 1;
+}
+
+// 5.11 之前 block_rq_issue 与 block_rq_requeue 的第一个参数是 request_queue
+SEC("tp_btf/block_rq_issue")
+int handle_block_rq_issue(u64 *ctx)
+{
+    if (LINUX_KERNEL_VERSION < KERNEL_VERSION(5, 11, 0))
+        return trace_issue((struct request *)ctx[1]);
+    return trace_issue((struct request *)ctx[0]);
+}
+
+SEC("tp_btf/block_rq_requeue")
+int handle_block_rq_requeue(u64 *ctx)
+{
+    struct block_req start;
+
+    if (LINUX_KERNEL_VERSION < KERNEL_VERSION(5, 11, 0))
+        finish((struct request *)ctx[1], &start);
+    else
+        finish((struct request *)ctx[0], &start);
+    return 0;
+}
+
+// 部分完成时 block_rq_complete 会触发多次，只有第一次找得到下发时间
+SEC("tp_btf/block_rq_complete")
+int BPF_PROG(handle_block_rq_complete, struct request *rq)
+{
+    struct block_req start;
+    struct block_hist *hist;
+    u64 delta;
+    u32 slot;
+
+    if (!finish(rq, &start))
+        return 0;
+    delta = bpf_ktime_get_ns() - start.ts;
+    hist = hist_of(start.dev, start.op);
+    if (!hist)
+        return 0;
+    slot = log2_u64(delta);
+    if (slot >= BLOCK_LAT_SLOTS)
+        slot = BLOCK_LAT_SLOTS - 1;
+    hist->lat_slots[slot]++;
+    hist->count++;
+    hist->sum_ns += delta;
+    return 0;
+}
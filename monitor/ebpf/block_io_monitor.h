@@ -0,0 +1,45 @@
+#ifndef __BLOCK_IO_MONITOR_H
+#define __BLOCK_IO_MONITOR_H
+
+typedef unsigned int __u32;
+typedef long long unsigned int __u64;
+
+// 已下发、尚未完成的请求数上限，表满时新请求不被跟踪，计入 BLOCK_STAT_START_DROPS
+#define BLOCK_START_ENTRIES 10240
+// 统计的块设备数上限；exporter 会删除已从 /proc/diskstats 消失的设备，上限只约束同时存在的设备数
+#define BLOCK_MAX_DEVICES 64
+
+// 延迟直方图：槽位 i 统计 [2^i, 2^(i+1)) 纳秒，最后一个槽位包含更大的值（约 34 秒以上）
+#define BLOCK_LAT_SLOTS 36
+// 下发时队列深度直方图：槽位 i 统计 [2^i, 2^(i+1)) 个在途请求
+#define BLOCK_DEPTH_SLOTS 16
+
+// 请求类型，对应 REQ_OP_* 的前四种，其余归入 BLOCK_OP_OTHER
+#define BLOCK_OP_READ 0
+#define BLOCK_OP_WRITE 1
+#define BLOCK_OP_FLUSH 2
+#define BLOCK_OP_DISCARD 3
+#define BLOCK_OP_OTHER 4
+#define BLOCK_OPS 5
+
+// dev 与内核的 dev_t 相同：major << 20 | minor
+struct block_hist_key {
+    __u32 dev;
+    __u32 op;
+};
+
+// block_hist 的值，每个 CPU 一份
+struct block_hist {
+    __u64 count;                            // 完成的请求数
+    __u64 sum_ns;
+    __u64 lat_slots[BLOCK_LAT_SLOTS];       // log2(下发到完成的 ns)
+    __u64 depth_sum;
+    __u64 depth_slots[BLOCK_DEPTH_SLOTS];   // log2(下发时该设备的在途请求数，含本请求)
+};
+
+// block_counters 的下标，每个 CPU 各自计数
+#define BLOCK_STAT_START_DROPS 0    // block_start 已满，请求未被跟踪
+#define BLOCK_STAT_HIST_DROPS 1     // 设备数超过 BLOCK_MAX_DEVICES，没有记录
+#define BLOCK_STAT_COUNTERS 2
+
+#endif  // __BLOCK_IO_MONITOR_H
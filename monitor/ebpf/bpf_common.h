@@ -0,0 +1,46 @@
+#ifndef __BPF_COMMON_H
+#define __BPF_COMMON_H
+
+// 各 BPF 程序共用的内联函数，在 vmlinux.h 与 bpf/bpf_helpers.h 之后包含
+
+// 无循环的 log2 向下取整，返回 v 最高位的位置（v 为0时返回0），用于 log2 直方图的槽位
+static __always_inline u32 log2_u32(u32 v)
+{
+    u32 r, shift;
+
+    r = (v > 0xFFFF) << 4; v >>= r;
+    shift = (v > 0xFF) << 3; v >>= shift; r |= shift;
+    shift = (v > 0xF) << 2; v >>= shift; r |= shift;
+    shift = (v > 0x3) << 1; v >>= shift; r |= shift;
+    r |= (v >> 1);
+    return r;
+}
+
+static __always_inline u32 log2_u64(u64 v)
+{
+    u32 hi = v >> 32;
+    if (hi)
+        return log2_u32(hi) + 32;
+    return log2_u32(v);
+}
+
+// counters 为 PERCPU_ARRAY（u32 -> u64）的事件计数，本 CPU 上 index 对应的计数加一
+static __always_inline void count_event(void *counters, u32 index)
+{
+    u64 *count = bpf_map_lookup_elem(counters, &index);
+    if (count)
+        (*count)++;
+}
+
+// 查找 key 对应的值，不存在时以 init 插入后重新查找；
+// 其他 CPU 可能同时插入同一个键，BPF_NOEXIST 失败后重新查找即可拿到。仍然找不到（表满）时返回 NULL
+static __always_inline void *lookup_or_try_init(void *map, const void *key, const void *init)
+{
+    void *value = bpf_map_lookup_elem(map, key);
+    if (value)
+        return value;
+    bpf_map_update_elem(map, key, init, BPF_NOEXIST);
+    return bpf_map_lookup_elem(map, key);
+}
+
+#endif /* __BPF_COMMON_H */
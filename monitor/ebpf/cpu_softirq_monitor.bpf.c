@@ -2,6 +2,7 @@
 #include <bpf/bpf_helpers.h>
 #include <bpf/bpf_tracing.h>
 #include "cpu_softirq_monitor.h" // 假设 softirq_stat 等结构在此定义
+#include "bpf_common.h"
 
 // 用于在 softirq_entry 和 softirq_exit 之间传递时间戳的哈希表
 struct {
@@ -20,6 +21,27 @@ struct {
     __type(value, struct softirq_stat);
 } softirq_stats SEC(".maps");
 
+// 超过阈值的软中断事件流
+struct {
+    __uint(type, BPF_MAP_TYPE_RINGBUF);
+    __uint(max_entries, 256 * 1024);
+} softirq_events SEC(".maps");
+
+// 事件阈值（纳秒），用户态可随时更新，0 表示关闭事件流
+struct {
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, u32);
+    __type(value, u64);
+} softirq_outlier_threshold SEC(".maps");
+
+// ringbuf 已满、预留失败而丢弃的事件数
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, u32);
+    __type(value, u64);
+} softirq_event_drops SEC(".maps");
 
 // 挂载到 softirq_entry 函数 (或 tracepoint)
 // SEC("kprobe/softirq_entry")
@@ -32,6 +54,20 @@ int handle_softirq_entry(struct trace_event_raw_softirq* ctx)
     return 0;
 }
 
+static __always_inline void emit_outlier(u64 now, u64 delta, u32 vec)
+{
+    struct softirq_event *event = bpf_ringbuf_reserve(&softirq_events, sizeof(*event), 0);
+    if (!event) {
+        count_event(&softirq_event_drops, 0);
+        return;
+    }
+    event->timestamp_ns = now;
+    event->duration_ns = delta;
+    event->cpu = bpf_get_smp_processor_id();
+    event->vec = vec;
+    bpf_ringbuf_submit(event, 0);
+}
+
 // 挂载到 softirq_exit 函数 (或 tracepoint)
 // SEC("kprobe/softirq_exit")
 SEC("tracepoint/irq/softirq_exit")
@@ -44,7 +80,12 @@ int handle_softirq_exit(struct trace_event_raw_softirq* ctx)
         return 0;
     }
 
-    u64 delta = bpf_ktime_get_ns() - *start_ts;
+    // 挂载时正处于软中断中间，没有对应的 entry 时间戳
+    if (*start_ts == 0)
+        return 0;
+    u64 now = bpf_ktime_get_ns();
+    u64 delta = now - *start_ts;
+    *start_ts = 0;
     
     // 从 tracepoint 上下文中获取软中断向量号 (vec)
     u32 vec = ctx->vec;
@@ -62,18 +103,23 @@ int handle_softirq_exit(struct trace_event_raw_softirq* ctx)
         return 0;
     }
 
-    // 【已修改】: 直接在获取到的指针上进行原子操作或普通更新
-    // 无需区分新旧元素，也无需再调用 map_update_elem
-    __sync_fetch_and_add(&stat->count, 1); // 使用原子加更安全
-    __sync_fetch_and_add(&stat->total_time_ns, delta);
-
-    // 对于 max_time_ns, 需要使用循环来原子地比较和交换 (CAS)
-    // 这是一个简化的非原子版本，在高并发下可能不精确，但在很多场景下足够
+    // softirq 在同一 CPU 上不会嵌套，PERCPU_ARRAY 中本 CPU 的数据只有这里会写，
+    // 因此计数、最大值和直方图都用普通读写即可，不需要原子操作
+    stat->count++;
+    stat->total_time_ns += delta;
     if (delta > stat->max_time_ns) {
         stat->max_time_ns = delta;
     }
-    
-    // (如果需要严格的原子max，可以使用 bpf_spin_lock + 普通更新)   
+
+    u32 slot = log2_u64(delta);
+    if (slot >= SOFTIRQ_HIST_SLOTS)
+        slot = SOFTIRQ_HIST_SLOTS - 1;
+    stat->hist[slot]++;
+
+    // 常见路径只多一次数组查找和一次比较
+    u64 *threshold = bpf_map_lookup_elem(&softirq_outlier_threshold, &key_map);
+    if (threshold && *threshold && delta >= *threshold)
+        emit_outlier(now, delta, vec);
 
     return 0;
 }
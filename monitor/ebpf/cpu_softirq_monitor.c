@@ -1,5 +1,6 @@
 // softirq_user.c
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <signal.h>
 #include <sys/resource.h>
@@ -56,6 +57,12 @@ int cleanup_ebpf_programs() {
 }
 
 void print() {
+    // softirq_stats 是 PERCPU_ARRAY，查找时内核按 CPU 个数写出整组数据
+    int ncpus = libbpf_num_possible_cpus();
+    struct softirq_stat *percpu = calloc(ncpus > 0 ? ncpus : 1, sizeof(*percpu));
+    if (!percpu)
+        return;
+
     while (!exiting) {
         sleep(2); // 2秒间隔
         
@@ -64,22 +71,29 @@ void print() {
         
         // 遍历所有软中断类型
         for (int vec = 0; vec < 10; vec++) {
-            struct softirq_stat stat;
+            struct softirq_stat stat = {0};
             int map_fd = bpf_map__fd(skel->maps.softirq_stats);
             
-            if (bpf_map_lookup_elem(map_fd, &vec, &stat) == 0) {
-                if (stat.count > 0) {
-                    double total_ms = (double)stat.total_time_ns / 1000000.0;
-                    double avg_us = (double)stat.total_time_ns / stat.count / 1000.0;
-                    double max_us = (double)stat.max_time_ns / 1000.0;
-                    
-                    printf("%-12s %-8llu %-12.2f %-12.2f %-12.2f\n",
-                           softirq_vec_names[vec], stat.count, 
-                           total_ms, avg_us, max_us);
-                }
+            if (bpf_map_lookup_elem(map_fd, &vec, percpu) != 0)
+                continue;
+            for (int cpu = 0; cpu < ncpus; cpu++) {
+                stat.count += percpu[cpu].count;
+                stat.total_time_ns += percpu[cpu].total_time_ns;
+                if (percpu[cpu].max_time_ns > stat.max_time_ns)
+                    stat.max_time_ns = percpu[cpu].max_time_ns;
+            }
+            if (stat.count > 0) {
+                double total_ms = (double)stat.total_time_ns / 1000000.0;
+                double avg_us = (double)stat.total_time_ns / stat.count / 1000.0;
+                double max_us = (double)stat.max_time_ns / 1000.0;
+                
+                printf("%-12s %-8llu %-12.2f %-12.2f %-12.2f\n",
+                       softirq_vec_names[vec], stat.count, 
+                       total_ms, avg_us, max_us);
             }
         }
     }
+    free(percpu);
 }
 
 
@@ -12,11 +12,23 @@ struct softirq_key {
     u32 vec;
 };
 
-// 用于存储统计信息的数据结构
+// 延迟直方图的槽位数：槽位 i 统计 [2^i, 2^(i+1)) 纳秒，最后一个槽位包含更大的值
+#define SOFTIRQ_HIST_SLOTS 32
+
+// 用于存储统计信息的数据结构（每个 CPU 一份，只由本 CPU 的 softirq_exit 更新）
 struct softirq_stat {
     u64 count;
     u64 total_time_ns;
     u64 max_time_ns;
+    u64 hist[SOFTIRQ_HIST_SLOTS];   // log2(ns) 延迟直方图
+};
+
+// 耗时超过阈值的软中断，通过 ringbuf 逐条上报
+struct softirq_event {
+    u64 timestamp_ns;   // 软中断结束时间（bpf_ktime_get_ns，CLOCK_MONOTONIC）
+    u64 duration_ns;
+    u32 cpu;
+    u32 vec;
 };
 
 int init_ebpf_programs();
@@ -1,20 +1,20 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
 #include <bpf/libbpf.h>
-#include "cpu_stat_monitor.skel.h"  
+#include <bpf/bpf.h>
+#include "cpu_stat_monitor.skel.h"
 
-struct kernel_cpustat {
-    unsigned long long cpustat[10];
-};
 static struct cpu_stat_monitor_bpf *skel;
-static int cpustats_map_fd = -1;
+static struct bpf_link *iter_link;
 
-int init_cpu_stat_monitor() 
+int init_cpu_stat_monitor()
 {
-    int err = 0, map_fd;
-    int key = 0;
+    DECLARE_LIBBPF_OPTS(bpf_iter_attach_opts, opts);
+    union bpf_iter_link_info linfo;
+    int err = 0, ncpus;
 
     // 打开BPF程序
     skel = cpu_stat_monitor_bpf__open();
@@ -22,7 +22,17 @@ int init_cpu_stat_monitor()
         // fprintf(stderr, "Failed to open BPF skeleton\n");
         return 1;
     }
-    
+
+    // 迭代器遍历 cpu_ids 的每个下标，容量与 possible CPU 数量一致
+    ncpus = libbpf_num_possible_cpus();
+    if (ncpus <= 0) {
+        err = ncpus ? ncpus : -EINVAL;
+        goto cleanup;
+    }
+    err = bpf_map__set_max_entries(skel->maps.cpu_ids, ncpus);
+    if (err)
+        goto cleanup;
+
     // 加载BPF程序
     err = cpu_stat_monitor_bpf__load(skel);
     if (err) {
@@ -30,23 +40,51 @@ int init_cpu_stat_monitor()
         goto cleanup;
     }
 
-    // 附加BPF程序
-    err = cpu_stat_monitor_bpf__attach(skel);
+    // 附加迭代器，之后每次 read_cpu_stats 都从这个 link 创建新的迭代器实例
+    memset(&linfo, 0, sizeof(linfo));
+    linfo.map.map_fd = bpf_map__fd(skel->maps.cpu_ids);
+    opts.link_info = &linfo;
+    opts.link_info_len = sizeof(linfo);
+    iter_link = bpf_program__attach_iter(skel->progs.dump_cpu_stat, &opts);
+    err = libbpf_get_error(iter_link);
     if (err) {
-        // fprintf(stderr, "Failed to attach BPF skeleton: %d\n", err);
+        iter_link = NULL;
         goto cleanup;
     }
-    
+
     return 0;
 cleanup:
     cpu_stat_monitor_bpf__destroy(skel);
+    skel = NULL;
     return err;
 }
 
-int get_cpustats_map_fd()
+int read_cpu_stats(struct cpu_stat *stats, int max)
 {
-    cpustats_map_fd = bpf_map__fd(skel->maps.cpu_stats);
-    return cpustats_map_fd;
+    size_t size = (size_t)max * sizeof(*stats), total = 0;
+    ssize_t n;
+    int fd;
+
+    if (!iter_link || max <= 0)
+        return -EINVAL;
+    fd = bpf_iter_create(bpf_link__fd(iter_link));
+    if (fd < 0)
+        return -errno;
+
+    // 输出不超过 seq_file 的缓冲区（8 页）时第一次 read() 就返回全部记录，下一次 read() 返回 0
+    while (total < size) {
+        n = read(fd, (char *)stats + total, size - total);
+        if (n < 0) {
+            n = -errno;
+            close(fd);
+            return n;
+        }
+        if (n == 0)
+            break;
+        total += n;
+    }
+    close(fd);
+    return total / sizeof(*stats);
 }
 
 // int main()
@@ -56,4 +94,4 @@ int get_cpustats_map_fd()
 //     while(1){};
 
 //     return 0;
-// }
\ No newline at end of file
+// }
@@ -1,15 +1,16 @@
 // bootstrap.h
 #ifndef __BOOTSTRAP_H
 #define __BOOTSTRAP_H
-#define MAX_CPU 128
+#define MAX_CPU 128     // cpu_ids 的默认容量，加载前会改为 possible CPU 数量
 
 typedef unsigned int __u32;
 typedef __u32 u32;
 typedef long long unsigned int __u64;
 typedef __u64 u64;
 
+// cpu_stat 迭代器输出的记录，每个在线 CPU 一条，按 CPU 号递增
 struct cpu_stat {
-    u64 online;
+    u64 cpu;
     u64 user;
     u64 nice;
     u64 system;
@@ -23,6 +24,7 @@ struct cpu_stat {
 };
 
 int init_cpu_stat_monitor();
-int get_cpustats_map_fd();
+// 读取一次迭代器，最多写入 max 条记录，返回记录数；出错时返回负的 errno
+int read_cpu_stats(struct cpu_stat *stats, int max);
 
 #endif /* __BOOTSTRAP_H */
\ No newline at end of file
@@ -0,0 +1,129 @@
+// 直接内存回收与直接规整的停顿时间，按 cgroup 统计
+#include "vmlinux.h"
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_tracing.h>
+#include <bpf/bpf_core_read.h>
+#include "mem_stall_monitor.h"
+#include "bpf_common.h"
+
+char LICENSE[] SEC("license") = "GPL";
+
+#define PF_KTHREAD 0x00200000
+
+// 各类停顿的开始时间（ns），0 表示不在该类停顿中；与 runqlat_monitor 一样放在任务本地存储里
+struct stall_start {
+    u64 ts[STALL_TYPES];
+};
+
+struct {
+    __uint(type, BPF_MAP_TYPE_TASK_STORAGE);
+    __uint(map_flags, BPF_F_NO_PREALLOC);
+    __type(key, int);
+    __type(value, struct stall_start);
+} mem_stall_start SEC(".maps");
+
+// exporter 删除已不存在的 cgroup
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_HASH);
+    __uint(max_entries, STALL_HIST_ENTRIES);
+    __type(key, struct stall_hist_key);
+    __type(value, struct stall_hist);
+} mem_stall_hist SEC(".maps");
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, STALL_STAT_COUNTERS);
+    __type(key, u32);
+    __type(value, u64);
+} mem_stall_counters SEC(".maps");
+
+static __always_inline void stall_begin(struct task_struct *task, u32 type)
+{
+    struct stall_start *start;
+
+    start = bpf_task_storage_get(&mem_stall_start, task, 0, BPF_LOCAL_STORAGE_GET_F_CREATE);
+    if (!start) {
+        count_event(&mem_stall_counters, STALL_STAT_NO_STORAGE);
+        return;
+    }
+    start->ts[type] = bpf_ktime_get_ns();
+}
+
+// 结束一次停顿，计入本 CPU 上 (cgroup, type) 的直方图，表满时计入 STALL_STAT_HIST_DROPS
+static __always_inline void stall_end(struct task_struct *task, u32 type, u64 pages)
+{
+    struct stall_hist_key key = {};
+    struct stall_hist *hist, zero = {};
+    struct stall_start *start;
+    u64 delta;
+    u32 slot;
+
+    start = bpf_task_storage_get(&mem_stall_start, task, 0, 0);
+    if (!start || !start->ts[type])
+        return;
+    delta = bpf_ktime_get_ns() - start->ts[type];
+    start->ts[type] = 0;
+
+    key.cgroup = bpf_get_current_cgroup_id();
+    key.type = type;
+    hist = lookup_or_try_init(&mem_stall_hist, &key, &zero);
+    if (!hist) {
+        count_event(&mem_stall_counters, STALL_STAT_HIST_DROPS);
+        return;
+    }
+    slot = log2_u64(delta);
+    if (slot >= STALL_HIST_SLOTS)
+        slot = STALL_HIST_SLOTS - 1;
+    hist->slots[slot]++;
+    hist->count++;
+    hist->sum_ns += delta;
+    hist->pages += pages;
+}
+
+// 各 tracepoint 的参数在不同内核版本间变化过，begin 不读参数，end 只读第一个参数 nr_reclaimed
+SEC("tp_btf/mm_vmscan_direct_reclaim_begin")
+int handle_direct_reclaim_begin(u64 *ctx)
+{
+    stall_begin(bpf_get_current_task_btf(), STALL_DIRECT_RECLAIM);
+    return 0;
+}
+
+SEC("tp_btf/mm_vmscan_direct_reclaim_end")
+int handle_direct_reclaim_end(u64 *ctx)
+{
+    stall_end(bpf_get_current_task_btf(), STALL_DIRECT_RECLAIM, ctx[0]);
+    return 0;
+}
+
+SEC("tp_btf/mm_vmscan_memcg_reclaim_begin")
+int handle_memcg_reclaim_begin(u64 *ctx)
+{
+    stall_begin(bpf_get_current_task_btf(), STALL_MEMCG_RECLAIM);
+    return 0;
+}
+
+SEC("tp_btf/mm_vmscan_memcg_reclaim_end")
+int handle_memcg_reclaim_end(u64 *ctx)
+{
+    stall_end(bpf_get_current_task_btf(), STALL_MEMCG_RECLAIM, ctx[0]);
+    return 0;
+}
+
+// compact_zone 也被 kcompactd 与主动规整调用，这些发生在内核线程中，不算作任务的停顿
+SEC("tp_btf/mm_compaction_begin")
+int handle_compaction_begin(u64 *ctx)
+{
+    struct task_struct *task = bpf_get_current_task_btf();
+
+    if (BPF_CORE_READ(task, flags) & PF_KTHREAD)
+        return 0;
+    stall_begin(task, STALL_COMPACTION);
+    return 0;
+}
+
+SEC("tp_btf/mm_compaction_end")
+int handle_compaction_end(u64 *ctx)
+{
+    stall_end(bpf_get_current_task_btf(), STALL_COMPACTION, 0);
+    return 0;
+}
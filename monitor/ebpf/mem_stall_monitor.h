@@ -0,0 +1,39 @@
+#ifndef __MEM_STALL_MONITOR_H
+#define __MEM_STALL_MONITOR_H
+
+typedef unsigned int __u32;
+typedef long long unsigned int __u64;
+
+// 停顿延迟直方图：槽位 i 统计 [2^i, 2^(i+1)) 纳秒，最后一个槽位包含更大的值（约 34 秒以上）
+#define STALL_HIST_SLOTS 36
+
+// mem_stall_hist 的容量（cgroup 数 x 停顿类型），表满时新的 (cgroup, 类型) 计入 STALL_STAT_HIST_DROPS
+#define STALL_HIST_ENTRIES 4096
+
+// 停顿类型：都发生在申请内存的任务自己的上下文中
+#define STALL_DIRECT_RECLAIM 0      // 全局内存不足时的直接回收
+#define STALL_MEMCG_RECLAIM 1       // 达到 cgroup 内存上限时的回收
+#define STALL_COMPACTION 2          // 申请高阶页时的直接规整（不含 kcompactd 等内核线程）
+#define STALL_TYPES 3
+
+// cgroup 为任务所在 cgroup v2 的 id
+struct stall_hist_key {
+    __u64 cgroup;
+    __u32 type;
+    __u32 pad;
+};
+
+// mem_stall_hist 的值，每个 CPU 一份
+struct stall_hist {
+    __u64 count;
+    __u64 sum_ns;
+    __u64 pages;                    // 回收类型：本次回收的页数之和；规整为0
+    __u64 slots[STALL_HIST_SLOTS];  // log2(ns)
+};
+
+// mem_stall_counters 的下标，每个 CPU 各自计数
+#define STALL_STAT_NO_STORAGE 0     // 任务本地存储创建失败，这次停顿没有记录
+#define STALL_STAT_HIST_DROPS 1     // mem_stall_hist 已满
+#define STALL_STAT_COUNTERS 2
+
+#endif  // __MEM_STALL_MONITOR_H
@@ -5,97 +5,258 @@
 #include <bpf/bpf_helpers.h>
 #include <bpf/bpf_tracing.h>
 #include "net_monitor.h"
+#include "bpf_common.h"
 
 char __license[] SEC("license") = "GPL";
 
 // eBPF Maps
+// 每个 CPU 独立计数，数据面无需原子操作也不会在核间争抢缓存行，exporter 读取时求和
 struct {
-    __uint(type, BPF_MAP_TYPE_HASH);
-    __uint(max_entries, 2);
-    __type(key, u32);
+    __uint(type, BPF_MAP_TYPE_PERCPU_HASH);
+    __uint(max_entries, MAX_TRAFFIC_KEYS);
+    __type(key, struct traffic_key);
     __type(value, struct ip_packet_info);
     // __uint(pinning, LIBBPF_PIN_BY_NAME);
 } packetsInfo SEC(".maps");
 
+struct {
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct flow_config);
+} flow_config SEC(".maps");
 
-SEC("tc")
-int tc_ingress(struct __sk_buff *ctx)
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 2 * FLOW_CMS_DEPTH);
+    __type(key, __u32);
+    __type(value, struct flow_cms_row);
+} flow_sketch SEC(".maps");
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 2);
+    __type(key, __u32);
+    __type(value, struct flow_topk);
+} flow_topk SEC(".maps");
+
+#define IPPROTO_ICMPV6_NR 58
+
+static __always_inline __u8 classify_l4(__u8 proto)
 {
-    if (ctx->ifindex != ETH0_IFINDEX) {
-        bpf_printk("Got packet not on eth0\n");
-        return TC_ACT_OK;
+    switch (proto) {
+    case IPPROTO_TCP:
+    case IPPROTO_UDP:
+    case IPPROTO_ICMP:
+    case IPPROTO_ICMPV6_NR:
+        return proto;
+    default:
+        return TRAFFIC_L4_OTHER;
     }
+}
+
+// 取 TCP/UDP 的端口（L4 头的前 4 字节），其余协议端口为 0
+static __always_inline void parse_ports(void *l4, void *data_end, __u8 proto, struct net_flow_key *flow)
+{
+    __be16 *ports = l4;
+
+    if (proto != IPPROTO_TCP && proto != IPPROTO_UDP)
+        return;
+    if ((void *)(ports + 2) > data_end)
+        return;
+    flow->sport = bpf_ntohs(ports[0]);
+    flow->dport = bpf_ntohs(ports[1]);
+}
 
-	void *data_end = (void *)(__u64)ctx->data_end;
-	void *data = (void *)(__u64)ctx->data;
-	struct ethhdr *l2;
-	struct iphdr *l3;
-
-	if (ctx->protocol != bpf_htons(ETH_P_IP))
-		return TC_ACT_OK;
-
-	l2 = data;
-	if ((void *)(l2 + 1) > data_end)
-		return TC_ACT_OK;
-
-	l3 = (struct iphdr *)(l2 + 1);
-	if ((void *)(l3 + 1) > data_end)
-		return TC_ACT_OK;
-    // bpf_printk("Get IP packet: tot_len: %d, ttl: %d", bpf_ntohs(l3->tot_len), l3->ttl);
-
-    u32 key = 0; // ingress
-    struct ip_packet_info *pinfo = bpf_map_lookup_elem(&packetsInfo, &key);
-    if (pinfo) {
-        pinfo->snd_rcv_bytes += ctx->len;
-        pinfo->snd_rcv_packets += 1;
-    } else {
-        struct ip_packet_info info = {};
-        info.snd_rcv_bytes = ctx->len;
-        info.snd_rcv_packets = 1;
-        bpf_map_update_elem(&packetsInfo, &key, &info, BPF_NOEXIST);
+// 解析以太网头（最多跳过一层 VLAN 标签）得到 L3/L4 协议和 5 元组；
+// IPv6 只看固定头的 next header，带扩展头的报文归入 L4 other；IPv4 分片只有首片带端口
+// tc 与 XDP 共用：data/data_end 都指向以太网帧，flow 需由调用方清零
+static __always_inline void parse_protocols(void *data, void *data_end, struct traffic_key *key,
+                                            struct net_flow_key *flow)
+{
+    struct ethhdr *l2 = data;
+    __u16 proto;
+    void *l3;
+
+    key->l3_proto = TRAFFIC_L3_OTHER;
+    key->l4_proto = TRAFFIC_L4_OTHER;
+
+    if ((void *)(l2 + 1) > data_end)
+        return;
+    proto = l2->h_proto;
+    l3 = l2 + 1;
+
+    if (proto == bpf_htons(ETH_P_8021Q) || proto == bpf_htons(ETH_P_8021AD)) {
+        struct vlan_hdr *vlan = l3;
+        if ((void *)(vlan + 1) > data_end)
+            return;
+        proto = vlan->h_vlan_encapsulated_proto;
+        l3 = vlan + 1;
     }
 
-	return TC_ACT_OK;
+    if (proto == bpf_htons(ETH_P_IP)) {
+        struct iphdr *ip = l3;
+        __u32 ihl;
+        key->l3_proto = flow->l3_proto = TRAFFIC_L3_IPV4;
+        if ((void *)(ip + 1) > data_end)
+            return;
+        key->l4_proto = classify_l4(ip->protocol);
+        flow->l4_proto = ip->protocol;
+        flow->saddr[0] = ip->saddr;
+        flow->daddr[0] = ip->daddr;
+        ihl = ip->ihl * 4;
+        if (ihl >= sizeof(*ip) && !(ip->frag_off & bpf_htons(0x1FFF)))
+            parse_ports(l3 + ihl, data_end, ip->protocol, flow);
+    } else if (proto == bpf_htons(ETH_P_IPV6)) {
+        struct ipv6hdr *ip6 = l3;
+        key->l3_proto = flow->l3_proto = TRAFFIC_L3_IPV6;
+        if ((void *)(ip6 + 1) > data_end)
+            return;
+        key->l4_proto = classify_l4(ip6->nexthdr);
+        flow->l4_proto = ip6->nexthdr;
+        __builtin_memcpy(flow->saddr, &ip6->saddr, sizeof(flow->saddr));
+        __builtin_memcpy(flow->daddr, &ip6->daddr, sizeof(flow->daddr));
+        parse_ports(ip6 + 1, data_end, ip6->nexthdr, flow);
+    }
 }
 
-SEC("tc")
-int tc_egress(struct __sk_buff *ctx)
+static __always_inline void account_packet(struct traffic_key *key, __u64 len)
+{
+    struct ip_packet_info *pinfo, zero = {};
+
+    pinfo = lookup_or_try_init(&packetsInfo, key, &zero);
+    if (!pinfo)
+        return;     // 表已满
+    pinfo->snd_rcv_bytes += len;
+    pinfo->snd_rcv_packets += 1;
+}
+
+static __always_inline __u64 flow_hash(const struct net_flow_key *flow)
+{
+    const __u64 *words = (const __u64 *)flow;
+    __u64 h = 0x9E3779B97F4A7C15ULL;
+
+#pragma unroll
+    for (int i = 0; i < sizeof(*flow) / 8; i++) {
+        h ^= words[i];
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+    }
+    return h;
+}
+
+static __always_inline bool flow_equal(const struct net_flow_key *a, const struct net_flow_key *b)
+{
+    const __u64 *x = (const __u64 *)a, *y = (const __u64 *)b;
+    __u64 diff = 0;
+
+#pragma unroll
+    for (int i = 0; i < sizeof(*a) / 8; i++)
+        diff |= x[i] ^ y[i];
+    return diff == 0;
+}
+
+// 同一条流只更新估计值；不同的流在估计值（按 rank 所选的维度）更大时占据该槽位
+static __always_inline void update_candidate(struct flow_candidate *c, const struct net_flow_key *flow,
+                                             __u64 bytes, __u64 packets, __u64 rank, __u64 current)
 {
-    if (ctx->ifindex != ETH0_IFINDEX) {
-        bpf_printk("Got packet not on eth0\n");
-        return TC_ACT_OK;
+    if (!flow_equal(&c->key, flow)) {
+        if (rank <= current)
+            return;
+        c->key = *flow;
     }
+    c->bytes = bytes;
+    c->packets = packets;
+}
 
-	void *data_end = (void *)(__u64)ctx->data_end;
-	void *data = (void *)(__u64)ctx->data;
-	struct ethhdr *l2;
-	struct iphdr *l3;
-
-	if (ctx->protocol != bpf_htons(ETH_P_IP))
-		return TC_ACT_OK;
-
-	l2 = data;
-	if ((void *)(l2 + 1) > data_end)
-		return TC_ACT_OK;
-
-	l3 = (struct iphdr *)(l2 + 1);
-	if ((void *)(l3 + 1) > data_end)
-		return TC_ACT_OK;
-
-	// bpf_printk("SendOut IP packet: tot_len: %d, ttl: %d", bpf_ntohs(l3->tot_len), l3->ttl);
-
-    u32 key = 1; // egress
-    struct ip_packet_info *pinfo = bpf_map_lookup_elem(&packetsInfo, &key);
-    if (pinfo) {
-        pinfo->snd_rcv_bytes += ctx->len;
-        pinfo->snd_rcv_packets += 1;
-    } else {
-        struct ip_packet_info info = {};
-        info.snd_rcv_bytes = ctx->len;
-        info.snd_rcv_packets = 1;
-        bpf_map_update_elem(&packetsInfo, &key, &info, BPF_NOEXIST);
+// count-min sketch：每行用 h1 + i*h2 选一个计数器，所有行的最小值即该流的估计值；
+// exporter 切换 epoch 时正在运行的程序可能仍写入旧的一份，最多影响切换瞬间的几个包
+static __always_inline void account_flow(const struct net_flow_key *flow, __u64 len)
+{
+    __u64 est_bytes = ~0ULL, est_packets = ~0ULL;
+    struct flow_config *cfg;
+    struct flow_topk *topk;
+    __u32 zero = 0, epoch;
+    __u32 h1, h2, slot;
+    __u64 h;
+
+    cfg = bpf_map_lookup_elem(&flow_config, &zero);
+    if (!cfg || !cfg->enabled)
+        return;
+    epoch = cfg->epoch & 1;
+
+    h = flow_hash(flow);
+    h1 = h;
+    h2 = (h >> 32) | 1;
+
+#pragma unroll
+    for (int i = 0; i < FLOW_CMS_DEPTH; i++) {
+        __u32 row_index = epoch * FLOW_CMS_DEPTH + i;
+        struct flow_cms_row *row = bpf_map_lookup_elem(&flow_sketch, &row_index);
+        struct flow_counter *cell;
+
+        if (!row)
+            return;
+        cell = &row->cells[(h1 + i * h2) & (FLOW_CMS_WIDTH - 1)];
+        cell->bytes += len;
+        cell->packets += 1;
+        if (cell->bytes < est_bytes)
+            est_bytes = cell->bytes;
+        if (cell->packets < est_packets)
+            est_packets = cell->packets;
     }
 
-	return TC_ACT_OK;
+    topk = bpf_map_lookup_elem(&flow_topk, &epoch);
+    if (!topk)
+        return;
+    slot = (h >> 56) & (FLOW_TOPK_SLOTS - 1);
+    update_candidate(&topk->by_bytes[slot], flow, est_bytes, est_packets,
+                     est_bytes, topk->by_bytes[slot].bytes);
+    update_candidate(&topk->by_packets[slot], flow, est_bytes, est_packets,
+                     est_packets, topk->by_packets[slot].packets);
 }
 
+static __always_inline int tc_account(struct __sk_buff *ctx, __u8 direction)
+{
+    struct traffic_key key = {
+        .ifindex = ctx->ifindex,
+        .direction = direction,
+    };
+    struct net_flow_key flow = {};
+
+    parse_protocols((void *)(__u64)ctx->data, (void *)(__u64)ctx->data_end, &key, &flow);
+    account_packet(&key, ctx->len);
+    account_flow(&flow, ctx->len);
+    return TC_ACT_OK;
+}
+
+SEC("tc")
+int tc_ingress(struct __sk_buff *ctx)
+{
+    return tc_account(ctx, TRAFFIC_INGRESS);
+}
+
+SEC("tc")
+int tc_egress(struct __sk_buff *ctx)
+{
+    return tc_account(ctx, TRAFFIC_EGRESS);
+}
+
+// XDP 入向计数：在驱动收包路径上、分配 skb 之前运行，计数结果与 tc_ingress 相同
+// （长度同样包含以太网头）；网卡不支持 XDP 时 init_net_monitor 回退到 tc_ingress
+SEC("xdp")
+int xdp_ingress(struct xdp_md *ctx)
+{
+    void *data = (void *)(long)ctx->data;
+    void *data_end = (void *)(long)ctx->data_end;
+    struct traffic_key key = {
+        .ifindex = ctx->ingress_ifindex,
+        .direction = TRAFFIC_INGRESS,
+    };
+    struct net_flow_key flow = {};
+
+    parse_protocols(data, data_end, &key, &flow);
+    account_packet(&key, data_end - data);
+    account_flow(&flow, data_end - data);
+    return XDP_PASS;
+}
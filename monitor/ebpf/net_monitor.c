@@ -1,85 +1,194 @@
 // SPDX-License-Identifier: (LGPL-2.1 OR BSD-2-Clause)
 /* Copyright (c) 2022 Hengqi Chen */
+#include <errno.h>
 #include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <net/if.h>
+#include <linux/if_link.h>
 #include "net_monitor.h"
 #include "net_monitor.skel.h"
 
 static volatile sig_atomic_t exiting = 0;
 static struct net_monitor_bpf *skel;
 static int packetsInfo_fd = 0;
-static bool hook_created = false;
-static struct bpf_tc_hook tc_hook_in, tc_hook_out;
-static struct bpf_tc_opts tc_opts_in, tc_opts_out;
 
-static void sig_int(int signo)
+// 每个网卡一对 ingress/egress 挂载点
+struct tc_attachment {
+	int ifindex;
+	int ingress_mode;	// 实际使用的入向挂载方式 NET_INGRESS_*
+	__u32 xdp_flags;	// 入向使用 XDP 时的挂载标志，退出时按同样的标志卸载
+	bool hook_created;	// clsact qdisc 是否由我们创建（退出时只销毁自己创建的）
+	bool attached_in, attached_out;
+	struct bpf_tc_hook hook_in, hook_out;
+	struct bpf_tc_opts opts_in, opts_out;
+};
+static struct tc_attachment attachments[MAX_NET_IFACES];
+static int attachment_count = 0;
+
+static void detach_all(void)
 {
-	tc_opts_in.flags = tc_opts_in.prog_fd = tc_opts_in.prog_id = 0;
-    tc_opts_out.flags = tc_opts_out.prog_fd = tc_opts_out.prog_id = 0;
-	bpf_tc_detach(&tc_hook_in, &tc_opts_in);
-	bpf_tc_detach(&tc_hook_out, &tc_opts_out);
-
-	if (hook_created) {
-		bpf_tc_hook_destroy(&tc_hook_in);
-		bpf_tc_hook_destroy(&tc_hook_out);
+	for (int i = 0; i < attachment_count; i++) {
+		struct tc_attachment *a = &attachments[i];
+
+		if (a->xdp_flags)
+			bpf_xdp_detach(a->ifindex, a->xdp_flags, NULL);
+		if (a->attached_in) {
+			a->opts_in.flags = a->opts_in.prog_fd = a->opts_in.prog_id = 0;
+			bpf_tc_detach(&a->hook_in, &a->opts_in);
+		}
+		if (a->attached_out) {
+			a->opts_out.flags = a->opts_out.prog_fd = a->opts_out.prog_id = 0;
+			bpf_tc_detach(&a->hook_out, &a->opts_out);
+		}
+		// ingress 与 egress 共用同一个 clsact qdisc，销毁一次即可
+		if (a->hook_created) {
+			a->hook_in.attach_point = BPF_TC_INGRESS | BPF_TC_EGRESS;
+			bpf_tc_hook_destroy(&a->hook_in);
+		}
 	}
+	attachment_count = 0;
+}
+
+static void sig_int(int signo)
+{
+	detach_all();
 	net_monitor_bpf__destroy(skel);
+	skel = NULL;
 }
 
-int init_net_monitor()
+// XDP_FLAGS_UPDATE_IF_NOEXIST：网卡上已有其他 XDP 程序时不替换它
+static int attach_xdp(struct tc_attachment *a, __u32 mode_flag)
 {
+	__u32 flags = XDP_FLAGS_UPDATE_IF_NOEXIST | mode_flag;
+	int err = bpf_xdp_attach(a->ifindex, bpf_program__fd(skel->progs.xdp_ingress), flags, NULL);
+	if (!err)
+		a->xdp_flags = flags;
+	return err;
+}
+
+static int attach_interface(int ifindex, int ingress_mode)
+{
+	struct tc_attachment *a = &attachments[attachment_count];
 	int err;
 
-	tc_hook_in.ifindex = ETH0_IFINDEX;
-	tc_hook_in.attach_point = BPF_TC_INGRESS;
-	tc_hook_in.sz = sizeof(struct bpf_tc_hook);
-	tc_opts_in.handle = 1;
-	tc_opts_in.priority = 1;
-	tc_opts_in.sz = sizeof(struct bpf_tc_opts);
-
-	tc_hook_out.ifindex = ETH0_IFINDEX;
-	tc_hook_out.attach_point = BPF_TC_EGRESS;
-	tc_hook_out.sz = sizeof(struct bpf_tc_hook);
-	tc_opts_out.handle = 1;
-	tc_opts_out.priority = 1;
-	tc_opts_out.sz = sizeof(struct bpf_tc_opts);
-
-    printf("Attaching to ifindex: %d\n", if_nametoindex("eth0"));
-    // 1. Open and load BPF application
-	skel = net_monitor_bpf__open_and_load();
-	if (!skel) {
-		printf("Failed to open BPF skeleton\n");
-		return 1;
-	}
+	memset(a, 0, sizeof(*a));
+	a->ifindex = ifindex;
+	a->hook_in.sz = sizeof(struct bpf_tc_hook);
+	a->hook_in.ifindex = ifindex;
+	a->hook_in.attach_point = BPF_TC_INGRESS;
+	a->hook_out = a->hook_in;
+	a->hook_out.attach_point = BPF_TC_EGRESS;
+	a->opts_in.sz = sizeof(struct bpf_tc_opts);
+	a->opts_in.handle = 1;
+	a->opts_in.priority = 1;
+	a->opts_out = a->opts_in;
+	// 先计入数组，失败时 detach_all 也能清理已完成的部分
+	attachment_count++;
 
-    // 2. Create TC hooks
-	err = bpf_tc_hook_create(&tc_hook_in);
+	err = bpf_tc_hook_create(&a->hook_in);
 	if (!err)
-		hook_created = true;
+		a->hook_created = true;
 	if (err && err != -EEXIST) {
-		printf("Failed to create TC hook: %d\n", err);
-		goto cleanup;
+		printf("Failed to create TC hook on ifindex %d: %d\n", ifindex, err);
+		return err;
 	}
 
-	err = bpf_tc_hook_create(&tc_hook_out);
-	if (!err)
-		hook_created = true;
-	if (err && err != -EEXIST) {
-		printf("Failed to create TC hook: %d\n", err);
-		goto cleanup;
+	// 入向：按要求的方式挂载 XDP，AUTO 在原生 XDP 不可用时回退到 tc。
+	// 通用 XDP 同样要先分配 skb，相比 tc 没有收益，因此 AUTO 不会选择它
+	switch (ingress_mode) {
+	case NET_INGRESS_XDP_NATIVE:
+	case NET_INGRESS_AUTO:
+		err = attach_xdp(a, XDP_FLAGS_DRV_MODE);
+		if (!err) {
+			a->ingress_mode = NET_INGRESS_XDP_NATIVE;
+			break;
+		}
+		if (ingress_mode == NET_INGRESS_XDP_NATIVE) {
+			printf("Failed to attach native XDP on ifindex %d: %d\n", ifindex, err);
+			return err;
+		}
+		printf("Native XDP unavailable on ifindex %d (%d), falling back to tc\n", ifindex, err);
+		a->ingress_mode = NET_INGRESS_TC;
+		break;
+	case NET_INGRESS_XDP_GENERIC:
+		err = attach_xdp(a, XDP_FLAGS_SKB_MODE);
+		if (err) {
+			printf("Failed to attach generic XDP on ifindex %d: %d\n", ifindex, err);
+			return err;
+		}
+		a->ingress_mode = NET_INGRESS_XDP_GENERIC;
+		break;
+	default:
+		a->ingress_mode = NET_INGRESS_TC;
+		break;
 	}
 
-    // 3. Attach BPF program to the hooks
-	tc_opts_in.prog_fd = bpf_program__fd(skel->progs.tc_ingress);
-	err = bpf_tc_attach(&tc_hook_in, &tc_opts_in);
-	if (err) {
-		printf("Failed to attach TC: %d\n", err);
-		goto cleanup;
+	if (a->ingress_mode == NET_INGRESS_TC) {
+		a->opts_in.prog_fd = bpf_program__fd(skel->progs.tc_ingress);
+		err = bpf_tc_attach(&a->hook_in, &a->opts_in);
+		if (err) {
+			printf("Failed to attach TC ingress on ifindex %d: %d\n", ifindex, err);
+			return err;
+		}
+		a->attached_in = true;
 	}
-	tc_opts_out.prog_fd = bpf_program__fd(skel->progs.tc_egress);
-	err = bpf_tc_attach(&tc_hook_out, &tc_opts_out);
+
+	a->opts_out.prog_fd = bpf_program__fd(skel->progs.tc_egress);
+	err = bpf_tc_attach(&a->hook_out, &a->opts_out);
 	if (err) {
-		printf("Failed to attach TC: %d\n", err);
+		printf("Failed to attach TC egress on ifindex %d: %d\n", ifindex, err);
+		return err;
+	}
+	a->attached_out = true;
+	return 0;
+}
+
+int init_net_monitor(const char *ifnames, int ingress_mode)
+{
+	char names[1024];
+	char *saveptr = NULL;
+	int err;
+
+	if (!ifnames || !*ifnames)
+		ifnames = "eth0";
+	snprintf(names, sizeof(names), "%s", ifnames);
+
+    // 1. Open and load BPF application
+	skel = net_monitor_bpf__open_and_load();
+	if (!skel) {
+		printf("Failed to open BPF skeleton\n");
+		return 1;
+	}
+
+    // 2. 在每个网卡上创建 TC hook 并挂载 ingress/egress 程序
+	for (char *name = strtok_r(names, ",", &saveptr); name; name = strtok_r(NULL, ",", &saveptr)) {
+		while (*name == ' ')
+			name++;
+		if (!*name)
+			continue;
+		if (attachment_count == MAX_NET_IFACES) {
+			printf("Too many interfaces, ignoring %s and the rest\n", name);
+			break;
+		}
+
+		int ifindex = if_nametoindex(name);
+		if (!ifindex) {
+			printf("Unknown interface %s: %s\n", name, strerror(errno));
+			err = ENODEV;
+			goto cleanup;
+		}
+		printf("Attaching to %s (ifindex %d)\n", name, ifindex);
+		err = attach_interface(ifindex, ingress_mode);
+		if (err) {
+			err = -err;
+			goto cleanup;
+		}
+	}
+	if (attachment_count == 0) {
+		err = EINVAL;
 		goto cleanup;
 	}
 
@@ -92,28 +201,55 @@ int init_net_monitor()
 	return 0;
 
 cleanup:
-	if (hook_created) {
-		bpf_tc_hook_destroy(&tc_hook_in);
-		bpf_tc_hook_destroy(&tc_hook_out);
-	}
+	detach_all();
 	net_monitor_bpf__destroy(skel);
-	return -err;
+	skel = NULL;
+	return err;
 }
 
 
+int net_monitor_attachment_count()
+{
+	return attachment_count;
+}
+
+int net_monitor_attachment(int i, int *ifindex, int *ingress_mode)
+{
+	if (i < 0 || i >= attachment_count)
+		return -1;
+	*ifindex = attachments[i].ifindex;
+	*ingress_mode = attachments[i].ingress_mode;
+	return 0;
+}
+
 int net_monitor_get_packetsinfo_fd()
 {
     packetsInfo_fd = bpf_map__fd(skel->maps.packetsInfo);
     return packetsInfo_fd;
 }
 
+int net_monitor_get_flow_config_fd()
+{
+    return bpf_map__fd(skel->maps.flow_config);
+}
+
+int net_monitor_get_flow_sketch_fd()
+{
+    return bpf_map__fd(skel->maps.flow_sketch);
+}
+
+int net_monitor_get_flow_topk_fd()
+{
+    return bpf_map__fd(skel->maps.flow_topk);
+}
+
 __attribute__((destructor)) void my_destructor(void) {
     sig_int(0);
 }
 
-int main()
+int main(int argc, char **argv)
 {
-    init_net_monitor();
+    init_net_monitor(argc > 1 ? argv[1] : NULL, argc > 2 ? atoi(argv[2]) : NET_INGRESS_AUTO);
 
     while(1){};
 
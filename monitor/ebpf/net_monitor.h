@@ -2,12 +2,42 @@
 #define _NET_MONITOR_H
 
 typedef unsigned long long __u64;
+typedef unsigned int __u32;
+typedef unsigned short __u16;
+typedef unsigned char __u8;
 
 #define LO_IFINDEX 1
 #define ETH0_IFINDEX 2
 
 #define TC_ACT_OK 0
 #define ETH_P_IP  0x0800 /* Internet Protocol packet	*/
+#define ETH_P_IPV6 0x86DD /* IPv6 over bluebook		*/
+#define ETH_P_8021Q 0x8100 /* 802.1Q VLAN Extended Header  */
+#define ETH_P_8021AD 0x88A8 /* 802.1ad Service VLAN		*/
+
+#define MAX_NET_IFACES 64           // init_net_monitor 最多挂载的网卡数
+#define MAX_TRAFFIC_KEYS 4096       // 流量统计表容量（网卡数 x 方向 x 协议组合）
+
+// 流量方向
+#define TRAFFIC_INGRESS 0
+#define TRAFFIC_EGRESS 1
+
+// L3 协议：按 IP 版本区分，其余归为 other
+#define TRAFFIC_L3_OTHER 0
+#define TRAFFIC_L3_IPV4 4
+#define TRAFFIC_L3_IPV6 6
+
+// L4 协议沿用 IPPROTO_* 编号（TCP 6、UDP 17、ICMP 1、ICMPv6 58），其余归为 other
+#define TRAFFIC_L4_OTHER 255
+
+// 流量统计的键：每个 (网卡, 方向, L3, L4) 组合一项，值在每个 CPU 上各有一份
+struct traffic_key {
+    __u32 ifindex;
+    __u8 direction;
+    __u8 l3_proto;
+    __u8 l4_proto;
+    __u8 pad;
+};
 
 struct ip_packet_info {
     __u64 snd_rcv_bytes;
@@ -16,9 +46,73 @@ struct ip_packet_info {
     // __u64 drop_in_out;
 };
 
-int init_net_monitor();
-// 获取 packetsInfo map 的文件描述符
+// 大流量（heavy hitter）检测：每个 CPU 一份 count-min sketch 加一张小的候选表，
+// 内存与流的数量无关，每个包的开销是固定的 FLOW_CMS_DEPTH 次计数加一次候选更新。
+// sketch 与候选表各有两份（epoch 0/1），exporter 每个周期切换 flow_config.epoch，
+// 然后读取并清零上一份，因此统计的是单个周期内的流量。
+#define FLOW_CMS_DEPTH 4            // sketch 的行数（独立哈希数）
+#define FLOW_CMS_WIDTH 512          // 每行的计数器个数，须为 2 的幂
+#define FLOW_TOPK_SLOTS 64          // 候选表槽位数，须为 2 的幂
+
+// 5 元组；按 8 字节对齐，便于 BPF 中按字比较和哈希
+struct net_flow_key {
+    __u32 saddr[4];     // 网络字节序，IPv4 只用 [0]
+    __u32 daddr[4];
+    __u16 sport;        // 主机字节序，非 TCP/UDP 为 0
+    __u16 dport;
+    __u8 l3_proto;      // TRAFFIC_L3_*
+    __u8 l4_proto;      // IPPROTO_* 原值
+    __u16 pad;
+} __attribute__((aligned(8)));
+
+struct flow_counter {
+    __u64 bytes;
+    __u64 packets;
+};
+
+// flow_sketch 的一项：sketch 的一行，键为 epoch * FLOW_CMS_DEPTH + 行号
+struct flow_cms_row {
+    struct flow_counter cells[FLOW_CMS_WIDTH];
+};
+
+// 候选流及其在本 CPU 上的 sketch 估计值（只会高估）
+struct flow_candidate {
+    struct net_flow_key key;
+    __u64 bytes;
+    __u64 packets;
+};
+
+// flow_topk 的一项，键为 epoch：按字节和按包数各一张候选表，
+// 流哈希到固定槽位，估计值超过槽位当前的候选时将其替换
+struct flow_topk {
+    struct flow_candidate by_bytes[FLOW_TOPK_SLOTS];
+    struct flow_candidate by_packets[FLOW_TOPK_SLOTS];
+};
+
+// flow_config 的唯一一项，由用户态写入
+struct flow_config {
+    __u32 enabled;      // 默认为0，BPF 只查一次 flow_config 就返回；exporter 设置了 NET_MONITOR_TOP_FLOWS 时置1
+    __u32 epoch;        // BPF 使用 epoch & 1 这一份 sketch 和候选表
+};
+
+// 入向计数的挂载方式
+#define NET_INGRESS_AUTO 0          // 先尝试原生 XDP，网卡驱动不支持时回退到 tc
+#define NET_INGRESS_XDP_NATIVE 1    // 只用原生（驱动）XDP，失败即报错
+#define NET_INGRESS_XDP_GENERIC 2   // 通用 XDP（在 skb 分配之后运行，主要用于测试）
+#define NET_INGRESS_TC 3            // tc clsact ingress
+
+// ifnames 为逗号分隔的网卡名（如 "bond0,bond0.100"），NULL 或空串时只挂载 eth0
+// ingress_mode 为 NET_INGRESS_*，出向始终使用 tc
+int init_net_monitor(const char *ifnames, int ingress_mode);
+// 已挂载的网卡数，以及第 i 个网卡的 ifindex 和实际使用的入向挂载方式（NET_INGRESS_*）
+int net_monitor_attachment_count();
+int net_monitor_attachment(int i, int *ifindex, int *ingress_mode);
+// 获取 packetsInfo map 的文件描述符（PERCPU_HASH，键为 struct traffic_key）
 int net_monitor_get_packetsinfo_fd();
+// 大流量检测相关 map 的文件描述符：flow_config（ARRAY）、flow_sketch 与 flow_topk（PERCPU_ARRAY）
+int net_monitor_get_flow_config_fd();
+int net_monitor_get_flow_sketch_fd();
+int net_monitor_get_flow_topk_fd();
 
 
 
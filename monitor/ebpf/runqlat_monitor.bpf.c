@@ -0,0 +1,143 @@
+// 运行队列延迟：任务被唤醒（或被抢占后仍可运行）到真正开始运行之间的排队时间
+#include "vmlinux.h"
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_tracing.h>
+#include <bpf/bpf_core_read.h>
+#include "runqlat_monitor.h"
+#include "bpf_common.h"
+
+char LICENSE[] SEC("license") = "GPL";
+
+#define TASK_RUNNING 0
+
+// 由 exporter 在加载前写入，非 0 时另外按 cgroup（cgroup v2 的 id）统计；
+// 加载后即为常量，关闭时验证器会删掉 cgroup 相关的代码
+const volatile __u32 per_cgroup = 0;
+
+// 任务进入运行队列的时间（ns），0 表示不在排队。保存在任务本地存储中：
+// 查找只是任务结构体上的一次指针访问，随任务释放，不需要按 pid 查哈希表，也不会因表满丢失
+struct {
+    __uint(type, BPF_MAP_TYPE_TASK_STORAGE);
+    __uint(map_flags, BPF_F_NO_PREALLOC);
+    __type(key, int);
+    __type(value, u64);
+} runq_start SEC(".maps");
+
+// 每个 CPU 一份直方图，记录在该 CPU 上排队的任务
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, u32);
+    __type(value, struct runq_hist);
+} runq_hist SEC(".maps");
+
+// 按 cgroup id 的直方图，只在 per_cgroup 打开时使用；exporter 删除已不存在的 cgroup
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_HASH);
+    __uint(max_entries, RUNQ_CGROUP_ENTRIES);
+    __type(key, u64);
+    __type(value, struct runq_hist);
+} runq_cgroup_hist SEC(".maps");
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, RUNQ_STAT_COUNTERS);
+    __type(key, u32);
+    __type(value, u64);
+} runq_counters SEC(".maps");
+
+// 5.14 之前 task_struct 的状态字段名为 state
+struct task_struct___pre_514 {
+    long state;
+} __attribute__((preserve_access_index));
+
+static __always_inline long task_state(struct task_struct *t)
+{
+    struct task_struct___pre_514 *old = (void *)t;
+
+    if (bpf_core_field_exists(t->__state))
+        return BPF_CORE_READ(t, __state);
+    return BPF_CORE_READ(old, state);
+}
+
+static __always_inline void enqueue(struct task_struct *p)
+{
+    u64 *ts;
+
+    // idle 任务不经过运行队列
+    if (!p->pid)
+        return;
+    ts = bpf_task_storage_get(&runq_start, p, 0, BPF_LOCAL_STORAGE_GET_F_CREATE);
+    if (!ts) {
+        count_event(&runq_counters, RUNQ_STAT_NO_STORAGE);
+        return;
+    }
+    *ts = bpf_ktime_get_ns();
+}
+
+static __always_inline void account(struct runq_hist *hist, u32 slot, u64 delta)
+{
+    hist->slots[slot]++;
+    hist->count++;
+    hist->sum_ns += delta;
+}
+
+// 查找或插入本 CPU 上该 cgroup 的直方图，表满时计入 RUNQ_STAT_CGROUP_DROPS
+static __always_inline void account_cgroup(struct task_struct *p, u32 slot, u64 delta)
+{
+    struct runq_hist *hist, zero = {};
+    u64 cgid = BPF_CORE_READ(p, cgroups, dfl_cgrp, kn, id);
+
+    hist = lookup_or_try_init(&runq_cgroup_hist, &cgid, &zero);
+    if (!hist) {
+        count_event(&runq_counters, RUNQ_STAT_CGROUP_DROPS);
+        return;
+    }
+    account(hist, slot, delta);
+}
+
+// tp_btf 直接拿到 task_struct 指针，比经典 tracepoint 少一次参数复制
+SEC("tp_btf/sched_wakeup")
+int BPF_PROG(handle_sched_wakeup, struct task_struct *p)
+{
+    enqueue(p);
+    return 0;
+}
+
+SEC("tp_btf/sched_wakeup_new")
+int BPF_PROG(handle_sched_wakeup_new, struct task_struct *p)
+{
+    enqueue(p);
+    return 0;
+}
+
+// 5.18 起 sched_switch 多了第四个参数 prev_state，这里只声明前三个，新旧内核都适用
+SEC("tp_btf/sched_switch")
+int BPF_PROG(handle_sched_switch, bool preempt, struct task_struct *prev, struct task_struct *next)
+{
+    struct runq_hist *hist;
+    u64 *ts, delta;
+    u32 slot, index = 0;
+
+    // 被抢占（或主动让出但仍可运行）的任务留在运行队列上，从现在开始计算它的排队时间
+    if (task_state(prev) == TASK_RUNNING)
+        enqueue(prev);
+
+    if (!next->pid)
+        return 0;
+    ts = bpf_task_storage_get(&runq_start, next, 0, 0);
+    if (!ts || !*ts)
+        return 0;
+    delta = bpf_ktime_get_ns() - *ts;
+    *ts = 0;
+
+    slot = log2_u64(delta);
+    if (slot >= RUNQ_HIST_SLOTS)
+        slot = RUNQ_HIST_SLOTS - 1;
+    hist = bpf_map_lookup_elem(&runq_hist, &index);
+    if (hist)
+        account(hist, slot, delta);
+    if (per_cgroup)
+        account_cgroup(next, slot, delta);
+    return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef __RUNQLAT_MONITOR_H
+#define __RUNQLAT_MONITOR_H
+
+typedef unsigned int __u32;
+typedef long long unsigned int __u64;
+
+// 运行队列延迟直方图的槽位数：槽位 i 统计 [2^i, 2^(i+1)) 纳秒，最后一个槽位包含更大的值
+#define RUNQ_HIST_SLOTS 32
+
+// 按 cgroup 统计时 runq_cgroup_hist 的容量，表满时新的 cgroup 计入 RUNQ_STAT_CGROUP_DROPS
+#define RUNQ_CGROUP_ENTRIES 1024
+
+// 一个直方图：runq_hist 中每个 CPU 一份（即任务排队所在的 CPU），
+// runq_cgroup_hist 中每个 cgroup 每个 CPU 一份
+struct runq_hist {
+    __u64 count;
+    __u64 sum_ns;
+    __u64 slots[RUNQ_HIST_SLOTS];   // log2(ns)
+};
+
+// runq_counters 的下标，每个 CPU 各自计数
+#define RUNQ_STAT_NO_STORAGE 0      // 任务本地存储创建失败，这次唤醒没有记录
+#define RUNQ_STAT_CGROUP_DROPS 1    // runq_cgroup_hist 已满，只计入每 CPU 的直方图
+#define RUNQ_STAT_COUNTERS 2
+
+#endif  // __RUNQLAT_MONITOR_H
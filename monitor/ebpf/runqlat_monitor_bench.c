@@ -0,0 +1,144 @@
+// 基准测试：runqlat_monitor 三个 tp_btf 程序每次运行的平均开销
+// 开启 BPF_STATS_RUN_TIME 后内核为每个程序累计 run_cnt 与 run_time_ns，
+// 测试期间由若干对进程通过管道互相唤醒，制造大量 sched_wakeup/sched_switch，
+// 结果为测试窗口内 run_time_ns 的增量除以 run_cnt 的增量（包含系统中其他任务触发的运行）。
+// 用法：runqlat_monitor_bench [往返次数] [按 cgroup 统计 0/1]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <bpf/bpf.h>
+#include <bpf/libbpf.h>
+#include "runqlat_monitor.skel.h"
+
+#define DEFAULT_ROUNDS 200000
+#define PAIRS 4
+#define TARGET_NS 100
+
+struct prog_stat {
+	const char *name;
+	struct bpf_program *prog;
+	__u64 run_cnt;
+	__u64 run_time_ns;
+};
+
+static int read_stat(struct prog_stat *s, __u64 *run_cnt, __u64 *run_time_ns)
+{
+	struct bpf_prog_info info;
+	__u32 len = sizeof(info);
+	int err;
+
+	memset(&info, 0, sizeof(info));
+	err = bpf_obj_get_info_by_fd(bpf_program__fd(s->prog), &info, &len);
+	if (err) {
+		fprintf(stderr, "get info of %s failed: %d\n", s->name, err);
+		return err;
+	}
+	*run_cnt = info.run_cnt;
+	*run_time_ns = info.run_time_ns;
+	return 0;
+}
+
+// 两个进程通过一对管道轮流读写一个字节，每次往返产生两次唤醒和至少两次切换
+static void ping_pong(int rounds)
+{
+	int ping[2], pong[2];
+	char c = 0;
+	pid_t pid;
+
+	if (pipe(ping) || pipe(pong))
+		exit(1);
+	pid = fork();
+	if (pid < 0)
+		exit(1);
+	if (pid == 0) {
+		for (int i = 0; i < rounds; i++) {
+			if (read(ping[0], &c, 1) != 1 || write(pong[1], &c, 1) != 1)
+				break;
+		}
+		exit(0);
+	}
+	for (int i = 0; i < rounds; i++) {
+		if (write(ping[1], &c, 1) != 1 || read(pong[0], &c, 1) != 1)
+			break;
+	}
+	waitpid(pid, NULL, 0);
+	exit(0);
+}
+
+int main(int argc, char **argv)
+{
+	int rounds = argc > 1 ? atoi(argv[1]) : DEFAULT_ROUNDS;
+	int per_cgroup = argc > 2 ? atoi(argv[2]) : 0;
+	struct runqlat_monitor_bpf *skel;
+	struct prog_stat stats[3];
+	__u64 cnt, time_ns, total_cnt = 0, total_ns = 0;
+	int stats_fd, err = 0, i;
+	pid_t pids[PAIRS];
+
+	if (rounds <= 0)
+		rounds = DEFAULT_ROUNDS;
+
+	skel = runqlat_monitor_bpf__open();
+	if (!skel) {
+		fprintf(stderr, "Failed to open BPF skeleton\n");
+		return 1;
+	}
+	skel->rodata->per_cgroup = per_cgroup ? 1 : 0;
+	err = runqlat_monitor_bpf__load(skel);
+	if (!err)
+		err = runqlat_monitor_bpf__attach(skel);
+	if (err) {
+		fprintf(stderr, "Failed to load and attach BPF skeleton: %d\n", err);
+		goto cleanup;
+	}
+
+	// 统计在这个 fd 关闭前一直有效
+	stats_fd = bpf_enable_stats(BPF_STATS_RUN_TIME);
+	if (stats_fd < 0) {
+		fprintf(stderr, "Failed to enable BPF run time stats: %d\n", stats_fd);
+		err = 1;
+		goto cleanup;
+	}
+
+	stats[0] = (struct prog_stat){ "sched_wakeup", skel->progs.handle_sched_wakeup };
+	stats[1] = (struct prog_stat){ "sched_wakeup_new", skel->progs.handle_sched_wakeup_new };
+	stats[2] = (struct prog_stat){ "sched_switch", skel->progs.handle_sched_switch };
+	for (i = 0; i < 3 && !err; i++)
+		err = read_stat(&stats[i], &stats[i].run_cnt, &stats[i].run_time_ns);
+	if (err)
+		goto close_stats;
+
+	for (i = 0; i < PAIRS; i++) {
+		pids[i] = fork();
+		if (pids[i] == 0)
+			ping_pong(rounds);
+	}
+	for (i = 0; i < PAIRS; i++) {
+		if (pids[i] > 0)
+			waitpid(pids[i], NULL, 0);
+	}
+
+	printf("%d pairs x %d round trips, per_cgroup=%d, target < %d ns/event\n",
+	       PAIRS, rounds, per_cgroup ? 1 : 0, TARGET_NS);
+	for (i = 0; i < 3; i++) {
+		err = read_stat(&stats[i], &cnt, &time_ns);
+		if (err)
+			goto close_stats;
+		cnt -= stats[i].run_cnt;
+		time_ns -= stats[i].run_time_ns;
+		total_cnt += cnt;
+		total_ns += time_ns;
+		printf("%-18s %10llu runs %8.1f ns/event\n", stats[i].name, cnt,
+		       cnt ? (double)time_ns / cnt : 0.0);
+	}
+	printf("%-18s %10llu runs %8.1f ns/event\n", "total", total_cnt,
+	       total_cnt ? (double)total_ns / total_cnt : 0.0);
+
+close_stats:
+	close(stats_fd);
+cleanup:
+	runqlat_monitor_bpf__destroy(skel);
+	return err ? 1 : 0;
+}
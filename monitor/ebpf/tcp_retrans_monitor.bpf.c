@@ -0,0 +1,125 @@
+// TCP 重传与平滑 RTT（srtt）统计，按对端子网或服务端口聚合
+#include "vmlinux.h"
+#include <bpf/bpf_endian.h>
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_tracing.h>
+#include "tcp_retrans_monitor.h"
+#include "bpf_common.h"
+
+char LICENSE[] SEC("license") = "GPL";
+
+#define AF_INET 2
+#define AF_INET6 10
+
+// 由 init_tcp_retrans_monitor 在加载前写入，加载后即为常量，验证器会消除未用到的分支
+const volatile __u32 key_mode = TCP_PEER_BY_SUBNET;
+const volatile __u32 ipv4_prefix = 24;
+const volatile __u32 ipv6_prefix = 64;
+const volatile __u32 rtt_sample_mask = 0;
+
+// LRU：对端数超过容量时淘汰最久未更新的对端，新出现的对端不会因为表满而一直无法统计
+struct {
+    __uint(type, BPF_MAP_TYPE_LRU_PERCPU_HASH);
+    __uint(max_entries, TCP_PEER_ENTRIES);
+    __type(key, struct tcp_peer_key);
+    __type(value, struct tcp_peer_stat);
+} tcp_peer_stats SEC(".maps");
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, u32);
+    __type(value, u64);
+} tcp_peer_drops SEC(".maps");
+
+// 网络字节序地址的前 prefix 位
+static __always_inline __u32 mask_word(__u32 addr, int bits)
+{
+    if (bits <= 0)
+        return 0;
+    if (bits >= 32)
+        return addr;
+    return addr & bpf_htonl(~0U << (32 - bits));
+}
+
+// 由对端地址和两端端口生成键；daddr_v6 为 IPv4 映射地址（::ffff:a.b.c.d）时按 IPv4 处理
+static __always_inline void make_peer_key(struct tcp_peer_key *key, __u16 family, __u32 daddr,
+                                          const __u32 *daddr_v6, __u16 lport, __u16 rport)
+{
+    if (key_mode == TCP_PEER_BY_PORT) {
+        key->port = lport < rport ? lport : rport;
+        key->family = family == AF_INET6 ? TCP_FAMILY_IPV6 : TCP_FAMILY_IPV4;
+        return;
+    }
+
+    if (family == AF_INET6 && !(daddr_v6[0] == 0 && daddr_v6[1] == 0 &&
+                                daddr_v6[2] == bpf_htonl(0x0000ffff))) {
+        key->family = TCP_FAMILY_IPV6;
+#pragma unroll
+        for (int i = 0; i < 4; i++)
+            key->addr[i] = mask_word(daddr_v6[i], (int)ipv6_prefix - 32 * i);
+        return;
+    }
+    key->family = TCP_FAMILY_IPV4;
+    key->addr[0] = mask_word(family == AF_INET6 ? daddr_v6[3] : daddr, ipv4_prefix);
+}
+
+// 查找或插入本 CPU 上该对端的统计，仍然找不到（LRU 无法腾出空位）时计入 tcp_peer_drops
+static __always_inline struct tcp_peer_stat *peer_stat(struct tcp_peer_key *key)
+{
+    struct tcp_peer_stat *stat, zero = {};
+
+    stat = lookup_or_try_init(&tcp_peer_stats, key, &zero);
+    if (!stat)
+        count_event(&tcp_peer_drops, 0);
+    return stat;
+}
+
+// tracepoint 已带有端口（主机字节序）和地址，不需要读取套接字；
+// 地址字段在 ctx 中不是 4 字节对齐的，先按字节复制出来
+SEC("tracepoint/tcp/tcp_retransmit_skb")
+int handle_tcp_retransmit_skb(struct trace_event_raw_tcp_event_sk_skb *ctx)
+{
+    struct tcp_peer_key key = {};
+    struct tcp_peer_stat *stat;
+    __u32 daddr, daddr_v6[4];
+
+    __builtin_memcpy(&daddr, ctx->daddr, sizeof(daddr));
+    __builtin_memcpy(daddr_v6, ctx->daddr_v6, sizeof(daddr_v6));
+    make_peer_key(&key, ctx->family, daddr, daddr_v6, ctx->sport, ctx->dport);
+    stat = peer_stat(&key);
+    if (stat)
+        stat->retransmits++;
+    return 0;
+}
+
+// 已建立连接收到报文（主要是 ACK）的快速路径，按 rtt_sample_mask 随机抽样读取 srtt
+SEC("fentry/tcp_rcv_established")
+int BPF_PROG(fentry_tcp_rcv_established, struct sock *sk)
+{
+    struct tcp_sock *tp = (struct tcp_sock *)sk;
+    struct sock_common *common = &sk->__sk_common;
+    struct tcp_peer_key key = {};
+    struct tcp_peer_stat *stat;
+    u32 srtt_us, slot;
+
+    if (rtt_sample_mask && (bpf_get_prandom_u32() & rtt_sample_mask))
+        return 0;
+    srtt_us = tp->srtt_us >> 3;     // srtt_us 以 1/8 微秒为单位保存
+    if (!srtt_us)
+        return 0;
+
+    make_peer_key(&key, common->skc_family, common->skc_daddr,
+                  common->skc_v6_daddr.in6_u.u6_addr32, common->skc_num, bpf_ntohs(common->skc_dport));
+    stat = peer_stat(&key);
+    if (!stat)
+        return 0;
+
+    slot = log2_u32(srtt_us);
+    if (slot >= TCP_RTT_SLOTS)
+        slot = TCP_RTT_SLOTS - 1;
+    stat->rtt_hist[slot]++;
+    stat->rtt_samples++;
+    stat->rtt_sum_us += srtt_us;
+    return 0;
+}
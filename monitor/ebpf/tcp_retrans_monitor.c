@@ -0,0 +1,49 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <bpf/libbpf.h>
+#include "tcp_retrans_monitor.h"
+#include "tcp_retrans_monitor.skel.h"
+
+static struct tcp_retrans_monitor_bpf *skel;
+
+int init_tcp_retrans_monitor(int key_mode, int ipv4_prefix, int ipv6_prefix, int rtt_sample_shift)
+{
+    int err;
+
+    skel = tcp_retrans_monitor_bpf__open();
+    if (!skel)
+        return 1;
+
+    // 只读数据必须在加载前写入
+    skel->rodata->key_mode = key_mode == TCP_PEER_BY_PORT ? TCP_PEER_BY_PORT : TCP_PEER_BY_SUBNET;
+    if (ipv4_prefix > 0 && ipv4_prefix <= 32)
+        skel->rodata->ipv4_prefix = ipv4_prefix;
+    if (ipv6_prefix > 0 && ipv6_prefix <= 128)
+        skel->rodata->ipv6_prefix = ipv6_prefix;
+    if (rtt_sample_shift > 0 && rtt_sample_shift < 32)
+        skel->rodata->rtt_sample_mask = (1U << rtt_sample_shift) - 1;
+
+    err = tcp_retrans_monitor_bpf__load(skel);
+    if (err)
+        goto cleanup;
+    err = tcp_retrans_monitor_bpf__attach(skel);
+    if (err)
+        goto cleanup;
+    return 0;
+
+cleanup:
+    tcp_retrans_monitor_bpf__destroy(skel);
+    skel = NULL;
+    return err;
+}
+
+int tcp_retrans_get_stats_fd()
+{
+    return bpf_map__fd(skel->maps.tcp_peer_stats);
+}
+
+int tcp_retrans_get_drops_fd()
+{
+    return bpf_map__fd(skel->maps.tcp_peer_drops);
+}
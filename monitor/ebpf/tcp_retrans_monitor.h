@@ -0,0 +1,43 @@
+#ifndef __TCP_RETRANS_MONITOR_H
+#define __TCP_RETRANS_MONITOR_H
+
+typedef unsigned char __u8;
+typedef unsigned short __u16;
+typedef unsigned int __u32;
+typedef long long unsigned int __u64;
+
+// 统计维度
+#define TCP_PEER_BY_SUBNET 0    // 对端子网（IPv4 默认 /24，IPv6 默认 /64）
+#define TCP_PEER_BY_PORT 1      // 端口：取本端与对端端口中较小的一个，通常就是服务端口
+
+#define TCP_PEER_ENTRIES 1024   // tcp_peer_stats 的容量，表满时淘汰最久未更新的对端
+#define TCP_RTT_SLOTS 24        // srtt 直方图槽位数：槽位 i 统计 [2^i, 2^(i+1)) 微秒，最后一个槽位包含更大的值
+
+#define TCP_FAMILY_IPV4 4
+#define TCP_FAMILY_IPV6 6
+
+// 对端的标识：按子网统计时 addr 为按前缀屏蔽后的对端地址（网络字节序，IPv4 只用 [0]）、port 为 0；
+// 按端口统计时 addr 全 0
+struct tcp_peer_key {
+    __u32 addr[4];
+    __u16 port;         // 主机字节序
+    __u8 family;        // TCP_FAMILY_*，IPv4 映射的 IPv6 地址按 IPv4 处理
+    __u8 pad;
+};
+
+// tcp_peer_stats 的值，每个 CPU 一份
+struct tcp_peer_stat {
+    __u64 retransmits;
+    __u64 rtt_samples;
+    __u64 rtt_sum_us;
+    __u64 rtt_hist[TCP_RTT_SLOTS];  // log2(srtt_us)
+};
+
+// key_mode 为 TCP_PEER_BY_*；prefix 为 0 时使用默认前缀；
+// 每 2^rtt_sample_shift 个 ACK 采样一次 srtt（按随机数抽样）
+int init_tcp_retrans_monitor(int key_mode, int ipv4_prefix, int ipv6_prefix, int rtt_sample_shift);
+// tcp_peer_stats（LRU_PERCPU_HASH，键为 struct tcp_peer_key）与 tcp_peer_drops（PERCPU_ARRAY，1 项）的文件描述符
+int tcp_retrans_get_stats_fd();
+int tcp_retrans_get_drops_fd();
+
+#endif  // __TCP_RETRANS_MONITOR_H
@@ -1,5 +1,5 @@
 
-// #include "tcp_stat_monitor.h"
+#include "tcp_stat_monitor.h"
 #include "tcp_stat_monitor.skel.h"
 
 
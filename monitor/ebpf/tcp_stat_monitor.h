@@ -0,0 +1,42 @@
+#ifndef __TCP_STAT_MONITOR_H
+#define __TCP_STAT_MONITOR_H
+
+typedef unsigned char __u8;
+typedef unsigned short __u16;
+typedef unsigned int __u32;
+typedef long long unsigned int __u64;
+
+// 三次握手中的连接数上限（LRU：SYN 洪泛时淘汰最旧的半连接，而不是拒绝新的握手）
+#define TCP_START_ENTRIES 16384
+
+// 握手延迟直方图的槽位数：槽位 i 统计 [2^i, 2^(i+1)) 微秒，最后一个槽位包含更大的值
+#define TCP_HIST_SLOTS 24
+
+// 按本端（监听）端口分别统计的端口数上限，限制指标基数与 map 内存；
+// 未配置的端口计入 hist 的最后一行（下标 TCP_MAX_PORTS）
+#define TCP_MAX_PORTS 64
+
+// hist 的一项：一个端口的直方图，键为 tcp_ports 中该端口的下标
+struct tcp_port_hist {
+    __u64 count;
+    __u64 sum_us;
+    __u64 slots[TCP_HIST_SLOTS];
+};
+
+// tcp_stat_counters 的下标，每个 CPU 各自计数
+#define TCP_STAT_STARTED 0      // 记录了 SYN 时间的握手
+#define TCP_STAT_START_FAILED 1 // start 更新失败（正常情况下 LRU 不会失败）
+#define TCP_STAT_NO_START 2     // 建连时找不到 SYN 时间：已被 LRU 淘汰、SYN cookie 或加载前开始的握手
+#define TCP_STAT_HIST_OVERFLOW 3 // 超出直方图范围，计入最后一个槽位
+#define TCP_STAT_COUNTERS 4
+
+// 握手的标识：IPv4 统一按 IPv4 映射的 IPv6 地址（::ffff:a.b.c.d）保存，
+// 这样双栈监听套接字上的 IPv4 连接在请求与子套接字两侧得到相同的键
+struct conn_key_t {
+    __u8 saddr[16];     // 本端地址
+    __u8 daddr[16];     // 对端地址
+    __u16 lport;        // 本端端口，主机字节序
+    __u16 rport;        // 对端端口，主机字节序
+};
+
+#endif  // __TCP_STAT_MONITOR_H
@@ -0,0 +1,195 @@
+package exporter
+
+import (
+    "bufio"
+    "fmt"
+    "os"
+    "strconv"
+    "strings"
+
+    "github.com/cilium/ebpf"
+    "github.com/cilium/ebpf/link"
+)
+
+// BlockIOMonitor 读取 block_io_monitor 按 (设备, 请求类型) 累计的延迟与队列深度直方图。
+// 设备名取自 /proc/diskstats，与 plain_disk_stat 的 device 标签一致；
+// 已从 /proc/diskstats 消失的设备（loop、dm、热插拔）连同其指标一起从 map 中删除，给新设备腾出位置
+type BlockIOMonitor struct {
+    monitor     *Monitor
+    histMap     *ebpf.Map
+    inflightMap *ebpf.Map
+    countersMap *ebpf.Map
+
+    devNames map[uint32]string
+    exported map[blockHistKey]string // 上一次导出的 (设备, 请求类型) 及其设备名
+}
+
+// attachBlockIOMonitoring 加载 block_io_monitor.bpf.o 并挂载到 block_rq_issue、block_rq_requeue 与 block_rq_complete
+func attachBlockIOMonitoring(codePath string) (*BlockIOMonitor, error) {
+    spec, err := ebpf.LoadCollectionSpec(codePath + ".output/block_io_monitor.bpf.o")
+    if err != nil {
+        return nil, fmt.Errorf("加载eBPF集合规范失败: %v", err)
+    }
+    collection, err := ebpf.NewCollection(spec)
+    if err != nil {
+        return nil, fmt.Errorf("创建eBPF集合失败: %v", err)
+    }
+    monitor := &Monitor{
+        coll: collection,
+    }
+    cleanup := func() {
+        for _, l := range monitor.links {
+            l.Close()
+        }
+        collection.Close()
+    }
+
+    for _, name := range []string{"handle_block_rq_issue", "handle_block_rq_requeue", "handle_block_rq_complete"} {
+        prog, ok := collection.Programs[name]
+        if !ok {
+            cleanup()
+            return nil, fmt.Errorf("找不到 %s 程序", name)
+        }
+        l, err := link.AttachTracing(link.TracingOptions{Program: prog})
+        if err != nil {
+            cleanup()
+            return nil, fmt.Errorf("附加 %s 失败: %v", name, err)
+        }
+        monitor.links = append(monitor.links, l)
+    }
+
+    b := &BlockIOMonitor{
+        monitor:     monitor,
+        histMap:     collection.Maps["block_hist"],
+        inflightMap: collection.Maps["block_inflight"],
+        countersMap: collection.Maps["block_counters"],
+        devNames:    make(map[uint32]string),
+        exported:    make(map[blockHistKey]string),
+    }
+    if b.histMap == nil || b.inflightMap == nil || b.countersMap == nil {
+        cleanup()
+        return nil, fmt.Errorf("找不到 block_io_monitor 的映射")
+    }
+    monitor.statsMap = b.histMap
+    return b, nil
+}
+
+// Update 把各 CPU 求和后的直方图交给 BlockIOLatency / BlockQueueDepth，并清理已消失的设备
+func (b *BlockIOMonitor) Update() error {
+    var key blockHistKey
+    var perCPU []blockHist
+    var total blockHist
+    gone := make(map[uint32]bool)
+    exported := make(map[blockHistKey]string, len(b.exported))
+
+    // 读取失败（或内容为空）时沿用上一次的设备名，不把所有设备当作已消失
+    if names := readDiskNames(); len(names) > 0 {
+        b.devNames = names
+    }
+    iter := b.histMap.Iterate()
+    for iter.Next(&key, &perCPU) {
+        name, ok := b.devNames[key.Dev]
+        if !ok {
+            gone[key.Dev] = true
+            continue
+        }
+        op := blockOpName(key.Op)
+
+        total = blockHist{}
+        for cpu := range perCPU {
+            h := &perCPU[cpu]
+            total.Count += h.Count
+            total.SumNs += h.SumNs
+            total.DepthSum += h.DepthSum
+            for slot := range h.LatSlots {
+                total.LatSlots[slot] += h.LatSlots[slot]
+            }
+            for slot := range h.DepthSlots {
+                total.DepthSlots[slot] += h.DepthSlots[slot]
+            }
+        }
+        // 深度直方图没有单独的计数，count 由槽位之和得到
+        BlockIOLatency.Set(total.Count, total.SumNs, total.LatSlots[:], name, op, "111")
+        BlockQueueDepth.Set(0, total.DepthSum, total.DepthSlots[:], name, op, "111")
+        exported[key] = name
+    }
+    if err := iter.Err(); err != nil {
+        return fmt.Errorf("遍历 block_hist 出错: %v", err)
+    }
+
+    // 本轮没有导出的序列（设备已消失，或设备号被重新分配给了另一个名字）
+    for key, name := range b.exported {
+        if exported[key] == name {
+            continue
+        }
+        BlockIOLatency.Delete(name, blockOpName(key.Op), "111")
+        BlockQueueDepth.Delete(name, blockOpName(key.Op), "111")
+    }
+    b.exported = exported
+
+    // 直方图表满时设备可能只在 block_inflight 中出现
+    var dev uint32
+    var inflight uint64
+    inflightIter := b.inflightMap.Iterate()
+    for inflightIter.Next(&dev, &inflight) {
+        if _, ok := b.devNames[dev]; !ok {
+            gone[dev] = true
+        }
+    }
+    if err := inflightIter.Err(); err != nil {
+        return fmt.Errorf("遍历 block_inflight 出错: %v", err)
+    }
+
+    // 已消失的设备从 map 中移除：所有请求类型的直方图和在途计数
+    for dev := range gone {
+        for op := range BlockOpNames {
+            b.histMap.Delete(blockHistKey{Dev: dev, Op: uint32(op)})
+        }
+        b.inflightMap.Delete(dev)
+    }
+
+    var counters []uint64
+    for i, name := range BlockCounterNames {
+        if err := b.countersMap.Lookup(uint32(i), &counters); err != nil {
+            return fmt.Errorf("读取 block_counters 失败: %v", err)
+        }
+        var sum uint64
+        for _, v := range counters {
+            sum += v
+        }
+        blockIODrops.Set(sum, name, "111")
+    }
+    return nil
+}
+
+func blockOpName(op uint32) string {
+    if int(op) < len(BlockOpNames) {
+        return BlockOpNames[op]
+    }
+    return "other"
+}
+
+// readDiskNames 从 /proc/diskstats 读取 dev_t（major << 20 | minor）到设备名的映射
+func readDiskNames() map[uint32]string {
+    names := make(map[uint32]string)
+    file, err := os.Open("/proc/diskstats")
+    if err != nil {
+        return names
+    }
+    defer file.Close()
+
+    scanner := bufio.NewScanner(file)
+    for scanner.Scan() {
+        fields := strings.Fields(scanner.Text())
+        if len(fields) < 3 {
+            continue
+        }
+        major, err1 := strconv.Atoi(fields[0])
+        minor, err2 := strconv.Atoi(fields[1])
+        if err1 != nil || err2 != nil {
+            continue
+        }
+        names[uint32(major)<<20|uint32(minor)] = fields[2]
+    }
+    return names
+}
@@ -0,0 +1,103 @@
+package exporter
+
+import (
+    "math"
+    "strings"
+    "sync"
+
+    "github.com/prometheus/client_golang/prometheus"
+)
+
+// BPF log2 直方图的通用 collector：内核侧按槽位累计（槽位 i 统计 [2^i, 2^(i+1)) 个单位，
+// 最后一个槽位包含更大的值），并各自维护 count 与 sum。
+// 更新时只保存每组标签的最新累计值，抓取时直接生成常量直方图，每组标签的开销与槽位数成正比，
+// 不像 HistogramVec 那样按事件数逐个 Observe。
+type log2Histogram struct {
+    desc   *prometheus.Desc
+    bounds []float64 // 槽位 i 的上界，已乘以 scale
+    scale  float64   // 内核单位到导出单位的换算系数，同样用于 sum
+
+    mu      sync.Mutex
+    entries map[string]*log2HistogramEntry
+}
+
+type log2HistogramEntry struct {
+    labels []string
+    count  uint64
+    sum    uint64
+    hist   []uint64
+}
+
+func newLog2Histogram(name, help string, labels []string, slots int, scale float64) *log2Histogram {
+    h := &log2Histogram{
+        desc:    prometheus.NewDesc(name, help, labels, nil),
+        scale:   scale,
+        entries: make(map[string]*log2HistogramEntry),
+    }
+    // 最后一个槽位没有上界，只计入 +Inf
+    for i := 0; i < slots-1; i++ {
+        h.bounds = append(h.bounds, math.Ldexp(1, i+1)*scale)
+    }
+    return h
+}
+
+// Set 保存一组标签的最新累计值；count 与 sum 取自内核，hist 的长度为槽位数
+func (h *log2Histogram) Set(count, sum uint64, hist []uint64, labelValues ...string) {
+    key := strings.Join(labelValues, "\xff")
+
+    h.mu.Lock()
+    defer h.mu.Unlock()
+
+    entry, ok := h.entries[key]
+    if !ok {
+        entry = &log2HistogramEntry{
+            labels: append([]string(nil), labelValues...),
+            hist:   make([]uint64, len(h.bounds)+1),
+        }
+        h.entries[key] = entry
+    }
+    entry.count = count
+    entry.sum = sum
+    copy(entry.hist, hist)
+}
+
+func (h *log2Histogram) Delete(labelValues ...string) {
+    h.mu.Lock()
+    delete(h.entries, strings.Join(labelValues, "\xff"))
+    h.mu.Unlock()
+}
+
+func (h *log2Histogram) Reset() {
+    h.mu.Lock()
+    h.entries = make(map[string]*log2HistogramEntry)
+    h.mu.Unlock()
+}
+
+func (h *log2Histogram) Describe(ch chan<- *prometheus.Desc) {
+    ch <- h.desc
+}
+
+func (h *log2Histogram) Collect(ch chan<- prometheus.Metric) {
+    h.mu.Lock()
+    defer h.mu.Unlock()
+
+    for _, entry := range h.entries {
+        ch <- h.metric(entry.count, entry.sum, entry.hist, entry.labels)
+    }
+}
+
+// metric 由一组累计值直接生成常量直方图，不保存到 entries；抓取时直接读取 map 的 collector 使用
+func (h *log2Histogram) metric(count, sum uint64, hist []uint64, labelValues []string) prometheus.Metric {
+    buckets := make(map[float64]uint64, len(h.bounds))
+    var cumulative uint64
+    for i, bound := range h.bounds {
+        cumulative += hist[i]
+        buckets[bound] = cumulative
+    }
+    cumulative += hist[len(h.bounds)]
+    // 各字段在内核中不是一起原子更新的，count 小于槽位之和时以槽位之和为准保证直方图自洽
+    if count < cumulative {
+        count = cumulative
+    }
+    return prometheus.MustNewConstHistogram(h.desc, count, float64(sum)*h.scale, buckets, labelValues...)
+}
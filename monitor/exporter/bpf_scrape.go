@@ -0,0 +1,211 @@
+package exporter
+
+import (
+    "errors"
+    "fmt"
+    "log"
+    "strconv"
+    "sync"
+
+    "github.com/cilium/ebpf"
+    "github.com/prometheus/client_golang/prometheus"
+)
+
+// 每个 CPU 的 kernel_cpustat 与 softirq_stats 在抓取时直接读取，不再由定时任务写入 GaugeVec：
+// kernel_cpustat 由 cpu_stat 迭代器一次 read() 取回所有在线 CPU 的记录，softirq_stats 用一次
+// BPF_MAP_LOOKUP_BATCH 读入预分配的缓冲区；Desc 与每个 (类型, CPU) 的标签值在创建时准备好，
+// 抓取只需要几次系统调用加上生成常量指标，数据也总是最新的。
+// 内核不支持批量读取（5.6 之前）时 softirq_stats 退回逐项 Lookup。
+type bpfScrapeCollector struct {
+    cpuStatDesc      *prometheus.Desc
+    softirqCountDesc *prometheus.Desc
+    softirqMaxDesc   *prometheus.Desc
+    softirqLatency   *log2Histogram
+
+    nCPU          int
+    cpuStatLabels [][][]string // [cpu][CpuStatsNames 下标]
+    softirqLabels [][][]string // [vec][cpu]
+
+    mu            sync.Mutex
+    readCpuStats  func([]cpu_stat) (int, error)
+    softirqMap    *ebpf.Map
+    batch         bool
+    cpuValues     []cpu_stat    // 迭代器输出的记录，每个在线 CPU 一条
+    softirqKeys   []uint32
+    softirqValues []SoftirqStat // [vec*nCPU + cpu]
+}
+
+func newBpfScrapeCollector() *bpfScrapeCollector {
+    nCPU, err := ebpf.PossibleCPU()
+    if err != nil || nCPU <= 0 {
+        log.Println("无法获取 possible CPU 数量: ", err)
+        nCPU = 1
+    }
+    c := &bpfScrapeCollector{
+        // 名称、帮助与标签和 cpuStatNumbers 相同，kmod 路径下直接转交给它
+        cpuStatDesc: prometheus.NewDesc(
+            "ebpf_cpu_stat",
+            "Process ebpf_cpu_stat",
+            []string{"cpu_stat_type", "cpu", "node"}, nil,
+        ),
+        softirqCountDesc: prometheus.NewDesc(
+            "ebpf_softirqs_operations_total",
+            "software interrupt number",
+            []string{"softirq_type", "cpu", "node"}, nil,
+        ),
+        softirqMaxDesc: prometheus.NewDesc(
+            "ebpf_softirqs_operations_times",
+            "software interrupt number",
+            []string{"softirq_type", "cpu", "node"}, nil,
+        ),
+        softirqLatency: newLog2Histogram(
+            "ebpf_softirq_latency_seconds",
+            "softirq handler latency per vector and cpu",
+            []string{"softirq_type", "cpu", "node"}, SoftirqHistSlots, 1e-9,
+        ),
+        nCPU:  nCPU,
+        batch: true,
+    }
+
+    c.cpuStatLabels = make([][][]string, nCPU)
+    for cpu := range c.cpuStatLabels {
+        cpuLabel := strconv.Itoa(cpu)
+        c.cpuStatLabels[cpu] = make([][]string, len(CpuStatsNames))
+        for i, name := range CpuStatsNames {
+            c.cpuStatLabels[cpu][i] = []string{name, cpuLabel, "111"}
+        }
+    }
+    c.softirqLabels = make([][][]string, len(SoftirqNames))
+    for vec, name := range SoftirqNames {
+        c.softirqLabels[vec] = make([][]string, nCPU)
+        for cpu := range c.softirqLabels[vec] {
+            c.softirqLabels[vec][cpu] = []string{name, strconv.Itoa(cpu), "111"}
+        }
+    }
+    return c
+}
+
+// SetSources 在 eBPF 程序加载后调用；readCpuStats 为 nil 时 ebpf_cpu_stat 来自内核模块（cpuStatNumbers）
+func (c *bpfScrapeCollector) SetSources(readCpuStats func([]cpu_stat) (int, error), softirqMap *ebpf.Map) {
+    c.mu.Lock()
+    defer c.mu.Unlock()
+
+    c.readCpuStats = readCpuStats
+    c.cpuValues = nil
+    if readCpuStats != nil {
+        c.cpuValues = make([]cpu_stat, c.nCPU)
+    }
+
+    c.softirqMap = softirqMap
+    c.softirqKeys, c.softirqValues = nil, nil
+    if softirqMap != nil {
+        n := int(softirqMap.MaxEntries())
+        if n > len(SoftirqNames) {
+            n = len(SoftirqNames)
+        }
+        c.softirqKeys = arrayKeys(n)
+        c.softirqValues = make([]SoftirqStat, n*c.nCPU)
+    }
+}
+
+func arrayKeys(n int) []uint32 {
+    keys := make([]uint32, n)
+    for i := range keys {
+        keys[i] = uint32(i)
+    }
+    return keys
+}
+
+// lookupBatch 一次读取 keys 中的全部项，per-CPU map 的 values 按 [key*nCPU + cpu] 排列。
+// 读到 map 末尾时内核返回 ENOENT，此时已读到的项仍然有效
+func (c *bpfScrapeCollector) lookupBatch(m *ebpf.Map, keys []uint32, values interface{}) (int, error) {
+    var cursor ebpf.MapBatchCursor
+    n, err := m.BatchLookup(&cursor, keys, values, nil)
+    if errors.Is(err, ebpf.ErrKeyNotExist) {
+        err = nil
+    }
+    if errors.Is(err, ebpf.ErrNotSupported) {
+        log.Println("内核不支持 BPF_MAP_LOOKUP_BATCH，改为逐项读取: ", err)
+        c.batch = false
+    }
+    return n, err
+}
+
+func (c *bpfScrapeCollector) readSoftirqStats() (int, error) {
+    if c.batch {
+        n, err := c.lookupBatch(c.softirqMap, c.softirqKeys, c.softirqValues)
+        if c.batch {
+            return n, err
+        }
+    }
+    var perCPU []SoftirqStat
+    for _, key := range c.softirqKeys {
+        if err := c.softirqMap.Lookup(key, &perCPU); err != nil {
+            return 0, err
+        }
+        copy(c.softirqValues[int(key)*c.nCPU:int(key+1)*c.nCPU], perCPU)
+    }
+    return len(c.softirqKeys), nil
+}
+
+func (c *bpfScrapeCollector) Describe(ch chan<- *prometheus.Desc) {
+    ch <- c.cpuStatDesc
+    ch <- c.softirqCountDesc
+    ch <- c.softirqMaxDesc
+    c.softirqLatency.Describe(ch)
+}
+
+func (c *bpfScrapeCollector) Collect(ch chan<- prometheus.Metric) {
+    c.mu.Lock()
+    defer c.mu.Unlock()
+
+    if c.readCpuStats == nil {
+        cpuStatNumbers.Collect(ch)
+    } else {
+        c.collectCpuStats(ch)
+    }
+    if c.softirqMap != nil {
+        c.collectSoftirqStats(ch)
+    }
+}
+
+func (c *bpfScrapeCollector) collectCpuStats(ch chan<- prometheus.Metric) {
+    n, err := c.readCpuStats(c.cpuValues)
+    if err != nil {
+        log.Println(err)
+        return
+    }
+    for i := range c.cpuValues[:n] {
+        stat := &c.cpuValues[i]
+        if stat.Cpu >= uint64(len(c.cpuStatLabels)) {
+            continue
+        }
+        fields := [...]uint64{stat.User, stat.Nice, stat.System, stat.Idle, stat.Iowait,
+            stat.Irq, stat.Softirq, stat.Steal, stat.Guest, stat.Guest_nice}
+        for field, v := range fields {
+            ch <- prometheus.MustNewConstMetric(c.cpuStatDesc, prometheus.GaugeValue, float64(v),
+                c.cpuStatLabels[stat.Cpu][field]...)
+        }
+    }
+}
+
+func (c *bpfScrapeCollector) collectSoftirqStats(ch chan<- prometheus.Metric) {
+    n, err := c.readSoftirqStats()
+    if err != nil {
+        log.Println(fmt.Errorf("读取 softirq_stats 失败: %v", err))
+        return
+    }
+    for _, vec := range c.softirqKeys[:n] {
+        for cpu := 0; cpu < c.nCPU; cpu++ {
+            stat := &c.softirqValues[int(vec)*c.nCPU+cpu]
+            // 只上报确实发生过该类型软中断的 CPU
+            if stat.Count == 0 {
+                continue
+            }
+            labels := c.softirqLabels[vec][cpu]
+            ch <- prometheus.MustNewConstMetric(c.softirqCountDesc, prometheus.GaugeValue, float64(stat.Count), labels...)
+            ch <- prometheus.MustNewConstMetric(c.softirqMaxDesc, prometheus.GaugeValue, float64(stat.MaxTimeNs), labels...)
+            ch <- c.softirqLatency.metric(stat.Count, stat.TotalTimeNs, stat.Hist[:], labels)
+        }
+    }
+}
@@ -0,0 +1,74 @@
+package exporter
+
+import (
+    "io/fs"
+    "path/filepath"
+    "strings"
+    "syscall"
+)
+
+// cgroup v2 的挂载点；cgroup 目录的 inode 号就是 BPF 看到的 cgroup id（kernfs 节点 id）
+const cgroupRoot = "/sys/fs/cgroup"
+
+// 每隔这么多次更新重新扫描一次 cgroup 目录树，发现已删除的 cgroup
+const cgroupRescanUpdates = 6
+
+// cgroupPaths 把按 cgroup id 统计的 BPF 映射中的 id 解析为相对 cgroupRoot 的路径
+type cgroupPaths struct {
+    paths     map[uint64]string
+    updates   int
+    rescanned bool
+    removed   func(path string) // 目录树中已经没有的 cgroup，删除对应的指标
+}
+
+func newCgroupPaths(removed func(path string)) *cgroupPaths {
+    return &cgroupPaths{
+        paths:   make(map[uint64]string),
+        removed: removed,
+    }
+}
+
+// begin 在每次遍历映射前调用，定期重新扫描目录树
+func (c *cgroupPaths) begin() {
+    c.updates++
+    c.rescanned = false
+    if c.updates%cgroupRescanUpdates == 0 {
+        c.scan()
+    }
+}
+
+// lookup 返回 cgroup id 对应的路径；新出现（或已被删除）的 cgroup 在每轮遍历中最多触发一次重新扫描，
+// 之后仍找不到的视为已删除，调用方应从映射中删除该项
+func (c *cgroupPaths) lookup(id uint64) (string, bool) {
+    path, ok := c.paths[id]
+    if !ok && !c.rescanned {
+        c.scan()
+        c.rescanned = true
+        path, ok = c.paths[id]
+    }
+    return path, ok
+}
+
+// scan 重建 cgroup id 到路径的映射
+func (c *cgroupPaths) scan() {
+    paths := make(map[uint64]string, len(c.paths))
+    filepath.WalkDir(cgroupRoot, func(path string, d fs.DirEntry, err error) error {
+        if err != nil || !d.IsDir() {
+            return nil
+        }
+        info, err := d.Info()
+        if err != nil {
+            return nil
+        }
+        if st, ok := info.Sys().(*syscall.Stat_t); ok {
+            paths[st.Ino] = "/" + strings.TrimPrefix(strings.TrimPrefix(path, cgroupRoot), "/")
+        }
+        return nil
+    })
+    for id, path := range c.paths {
+        if _, ok := paths[id]; !ok && c.removed != nil {
+            c.removed(path)
+        }
+    }
+    c.paths = paths
+}
@@ -0,0 +1,69 @@
+package exporter
+
+import (
+    "strings"
+    "sync"
+
+    "github.com/prometheus/client_golang/prometheus"
+)
+
+// 已在内核 map 或共享内存中累计好的计数的 collector：更新时保存每组标签的最新累计值，
+// 抓取时生成 CounterValue 常量指标。CounterVec 只能 Add，而用 GaugeVec.Set 镜像累计值会让 _total 指标的类型变成 gauge。
+type constCounterVec struct {
+    desc *prometheus.Desc
+
+    mu      sync.Mutex
+    entries map[string]*constCounterEntry
+}
+
+type constCounterEntry struct {
+    labels []string
+    value  uint64
+}
+
+func newConstCounterVec(name, help string, labels []string) *constCounterVec {
+    return &constCounterVec{
+        desc:    prometheus.NewDesc(name, help, labels, nil),
+        entries: make(map[string]*constCounterEntry),
+    }
+}
+
+// Set 保存一组标签的最新累计值
+func (c *constCounterVec) Set(value uint64, labelValues ...string) {
+    key := strings.Join(labelValues, "\xff")
+
+    c.mu.Lock()
+    defer c.mu.Unlock()
+
+    entry, ok := c.entries[key]
+    if !ok {
+        entry = &constCounterEntry{labels: append([]string(nil), labelValues...)}
+        c.entries[key] = entry
+    }
+    entry.value = value
+}
+
+func (c *constCounterVec) Delete(labelValues ...string) {
+    c.mu.Lock()
+    delete(c.entries, strings.Join(labelValues, "\xff"))
+    c.mu.Unlock()
+}
+
+func (c *constCounterVec) Reset() {
+    c.mu.Lock()
+    c.entries = make(map[string]*constCounterEntry)
+    c.mu.Unlock()
+}
+
+func (c *constCounterVec) Describe(ch chan<- *prometheus.Desc) {
+    ch <- c.desc
+}
+
+func (c *constCounterVec) Collect(ch chan<- prometheus.Metric) {
+    c.mu.Lock()
+    defer c.mu.Unlock()
+
+    for _, entry := range c.entries {
+        ch <- prometheus.MustNewConstMetric(c.desc, prometheus.CounterValue, float64(entry.value), entry.labels...)
+    }
+}
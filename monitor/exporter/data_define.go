@@ -40,19 +40,184 @@ type SoftirqKey struct {
     Vec uint32
 }
 
+// 与 cpu_softirq_monitor.h 中的 SOFTIRQ_HIST_SLOTS 一致
+const SoftirqHistSlots = 32
+
 type SoftirqStat struct {
     Count       uint64
     TotalTimeNs uint64
     MaxTimeNs   uint64
+    Hist        [SoftirqHistSlots]uint64 // 槽位 i 统计 [2^i, 2^(i+1)) 纳秒
+}
+
+// 对应 net_monitor.h 中的 struct traffic_key
+type trafficKey struct {
+    Ifindex   uint32
+    Direction uint8
+    L3Proto   uint8
+    L4Proto   uint8
+    Pad       uint8
+}
+
+// L3/L4 协议编号到标签值
+var TrafficL3Names = map[uint8]string{
+    0: "other",
+    4: "ipv4",
+    6: "ipv6",
+}
+
+var TrafficL4Names = map[uint8]string{
+    1:   "icmp",
+    6:   "tcp",
+    17:  "udp",
+    58:  "icmpv6",
+    255: "other",
+}
+
+// 对应 tcp_stat_monitor.h：直方图槽位数、单独统计的端口数上限与 tcp_stat_counters 的下标
+const (
+    tcpHistSlots = 24
+    tcpMaxPorts  = 64
+)
+
+// struct tcp_port_hist
+type tcpPortHist struct {
+    Count uint64
+    SumUs uint64
+    Slots [tcpHistSlots]uint64
+}
+
+var TcpStatCounterNames = []string{"started", "start_failed", "no_start", "hist_overflow"}
+
+// 对应 tcp_retrans_monitor.h
+const tcpRttSlots = 24
+
+var TcpPeerModeNames = []string{"subnet", "port"}
+
+type tcpPeerKey struct {
+    Addr   [16]byte // 网络字节序，IPv4 只用前 4 字节
+    Port   uint16
+    Family uint8
+    Pad    uint8
+}
+
+type tcpPeerStat struct {
+    Retransmits uint64
+    RttSamples  uint64
+    RttSumUs    uint64
+    RttHist     [tcpRttSlots]uint64
 }
 
+// 对应 runqlat_monitor.h
+const runqHistSlots = 32
+
+// struct runq_hist
+type runqHist struct {
+    Count uint64
+    SumNs uint64
+    Slots [runqHistSlots]uint64
+}
+
+// runq_counters 的下标
+var RunqCounterNames = []string{"no_storage", "cgroup_full"}
+
+// 对应 block_io_monitor.h
+const (
+    blockLatSlots   = 36
+    blockDepthSlots = 16
+)
+
+// 下标为 BLOCK_OP_*
+var BlockOpNames = []string{"read", "write", "flush", "discard", "other"}
+
+// block_counters 的下标
+var BlockCounterNames = []string{"start_full", "device_full"}
+
+type blockHistKey struct {
+    Dev uint32 // major << 20 | minor
+    Op  uint32
+}
+
+type blockHist struct {
+    Count      uint64
+    SumNs      uint64
+    LatSlots   [blockLatSlots]uint64
+    DepthSum   uint64
+    DepthSlots [blockDepthSlots]uint64
+}
+
+// 对应 mem_stall_monitor.h
+const (
+    memStallHistSlots  = 36
+    memStallCompaction = 2 // STALL_COMPACTION
+)
+
+// 下标为 STALL_*
+var MemStallTypeNames = []string{"direct_reclaim", "memcg_reclaim", "compaction"}
+
+// mem_stall_counters 的下标
+var MemStallCounterNames = []string{"no_storage", "table_full"}
+
+type memStallKey struct {
+    Cgroup uint64
+    Type   uint32
+    _      uint32
+}
+
+type memStallHist struct {
+    Count uint64
+    SumNs uint64
+    Pages uint64
+    Slots [memStallHistSlots]uint64
+}
+
+// 对应 net_monitor.h 中大流量检测的常量与结构体
+const (
+    flowCmsDepth  = 4
+    flowCmsWidth  = 512
+    flowTopKSlots = 64
+)
+
+type netFlowKey struct {
+    Saddr   [16]byte // 网络字节序，IPv4 只用前 4 字节
+    Daddr   [16]byte
+    Sport   uint16
+    Dport   uint16
+    L3Proto uint8
+    L4Proto uint8
+    Pad     uint16
+}
+
+type flowCandidate struct {
+    Key     netFlowKey
+    Bytes   uint64
+    Packets uint64
+}
+
+type flowTopK struct {
+    ByBytes   [flowTopKSlots]flowCandidate
+    ByPackets [flowTopKSlots]flowCandidate
+}
+
+// struct flow_cms_row：flowCmsWidth 个 {bytes, packets}
+type flowCmsRow [flowCmsWidth * 2]uint64
+
+type flowConfig struct {
+    Enabled uint32
+    Epoch   uint32
+}
+
+// 对应 net_monitor.h 中的 NET_INGRESS_*，下标即取值
+var NetIngressModeNames = []string{"auto", "xdp", "xdp-generic", "tc"}
+
 type ip_packet_info struct {
      Snd_rcv_bytes uint64
      Snd_rcv_packets uint64
 }
 
+// 对应 cpu_stat_monitor.h 中的 struct cpu_stat，即 cpu_stat 迭代器输出的一条记录
 type cpu_stat struct {
-     Online uint64
+     Cpu    uint64
      User   uint64
      Nice   uint64
      System   uint64
@@ -65,6 +230,226 @@ type cpu_stat struct {
      Guest_nice   uint64
 }
 
+// /dev/cpu_stat_monitor 映射的环形缓冲区布局，对应 plain_monitor/cpu_stat_ring.h
+const (
+    cpuStatRingMagic   = 0x52535043
+    cpuStatRingVersion = 1
+)
+
+// 内核模块中的 struct cpu_stat：online 是 u32，其后有4字节填充（eBPF 侧的 cpu_stat 中 online 是 u64）
+type kmodCpuStat struct {
+     Online     uint32
+     _          uint32
+     User       uint64
+     Nice       uint64
+     System     uint64
+     Idle       uint64
+     Iowait     uint64
+     Irq        uint64
+     Softirq    uint64
+     Steal      uint64
+     Guest      uint64
+     Guest_nice uint64
+}
+
+type cpuStatRingHeader struct {
+    Magic      uint32
+    Version    uint32
+    NrCpus     uint32
+    NrSlots    uint32
+    SlotOffset uint32
+    SlotSize   uint32
+    StatSize   uint32
+    Reserved   uint32
+    PeriodNs   uint64
+    Generation uint64
+    Missed     uint64
+}
+
+type cpuStatSlotHeader struct {
+    Seq         uint64
+    Generation  uint64
+    TimestampNs uint64
+    Reserved    uint64
+}
+
+
+// plain_monitord 共享内存快照中的结构，与 plain_monitor 下的 C 定义逐字段对应
+// MemInfo 全部字段均为 unsigned long，按 C 结构体顺序排列，名称见 MemInfoNames
+var MemInfoNames = []string{
+    "MemTotal",
+    "MemFree",
+    "MemAvailable",
+    "Buffers",
+    "Cached",
+    "SwapTotal",
+    "SwapFree",
+    "SwapCached",
+    "Active",
+    "Inactive",
+    "Active(anon)",
+    "Inactive(anon)",
+    "Active(file)",
+    "Inactive(file)",
+    "Unevictable",
+    "Mlocked",
+    "HighTotal",
+    "HighFree",
+    "LowTotal",
+    "LowFree",
+    "MmapCopy",
+    "Zswap",
+    "Zswapped",
+    "Dirty",
+    "Writeback",
+    "AnonPages",
+    "Mapped",
+    "Shmem",
+    "KReclaimable",
+    "Slab",
+    "SReclaimable",
+    "SUnreclaim",
+    "KernelStack",
+    "ShadowCallStack",
+    "PageTables",
+    "SecPageTables",
+    "NFS_Unstable",
+    "Bounce",
+    "WritebackTmp",
+    "CommitLimit",
+    "Committed_AS",
+    "VmallocTotal",
+    "VmallocUsed",
+    "VmallocChunk",
+    "Percpu",
+    "HardwareCorrupted",
+    "AnonHugePages",
+    "ShmemHugePages",
+    "ShmemPmdMapped",
+    "FileHugePages",
+    "FilePmdMapped",
+    "CmaTotal",
+    "CmaFree",
+    "Unaccepted",
+    "Balloon",
+    "HugePages_Total",
+    "HugePages_Free",
+    "HugePages_Rsvd",
+    "HugePages_Surp",
+    "Hugepagesize",
+    "Hugetlb",
+    "DirectMap4k",
+    "DirectMap2M",
+    "DirectMap4M",
+    "DirectMap1G",
+}
+
+const MemInfoFields = 65
+
+type MemInfo [MemInfoFields]uint64
+
+// 对应 LoadAvgData，cpu_count 之后有4字节填充
+type LoadAvg struct {
+    Load1min         float64
+    Load5min         float64
+    Load15min        float64
+    CpuCount         int32
+    _                int32
+    Load1minPerCore  float64
+    Load5minPerCore  float64
+    Load15minPerCore float64
+    Load1s           float64
+    Load10s          float64
+    Load60s          float64
+}
+
+// 对应 PsiTrigger（plain_monitor/psi_monitor.h）
+const PsiCgroupLen = 128
+
+type PsiTrigger struct {
+    Cgroup      [PsiCgroupLen]byte
+    Resource    uint32
+    Full        uint16
+    Active      uint16
+    StallUs     uint64
+    WindowUs    uint64
+    Events      uint64
+    LastEventNs uint64
+    Avg10       float64
+    Avg60       float64
+    Avg300      float64
+    TotalUs     uint64
+}
+
+// 下标与 PSI_CPU / PSI_MEMORY / PSI_IO 一致
+var PsiResourceNames = []string{"cpu", "memory", "io"}
+
+// 对应 NodeStats（plain_monitor/numa_monitor.h），Stats 的顺序与 NodeStatNames 一致
+type NodeStats struct {
+    Node  uint32
+    Valid uint32
+    Stats [17]uint64
+}
+
+var NodeStatNames = []string{
+    "mem_total_kb",
+    "mem_free_kb",
+    "file_kb",
+    "anon_kb",
+    "shmem_kb",
+    "slab_reclaimable_kb",
+    "numa_hit",
+    "numa_miss",
+    "numa_foreign",
+    "interleave_hit",
+    "local_node",
+    "other_node",
+    "workingset_refault_anon",
+    "workingset_refault_file",
+    "pgpromote_success",
+    "pgdemote_kswapd",
+    "pgdemote_direct",
+}
+
+// plain_disk_stat 的 disk_stat_type 标签，按 UpdatePlainMetrics 中的导出顺序
+var PlainDiskStatNames = []string{
+    "read_throughput_mb",
+    "write_throughput_mb",
+    "read_iops",
+    "write_iops",
+    "avg_read_latency_ms",
+    "avg_write_latency_ms",
+    "utilization",
+    "ios_in_progress",
+}
+
+// 对应 DiskStats
+type DiskStats struct {
+    Name              [32]byte
+    Major             uint32
+    Minor             uint32
+    ReadsCompleted    uint64
+    ReadsMerged       uint64
+    SectorsRead       uint64
+    TimeReadingMs     uint64
+    WritesCompleted   uint64
+    WritesMerged      uint64
+    SectorsWritten    uint64
+    TimeWritingMs     uint64
+    IosInProgress     uint64
+    TimeIoMs          uint64
+    WeightedTimeIoMs  uint64
+    ReadThroughputMb  float64
+    WriteThroughputMb float64
+    TotalThroughputMb float64
+    ReadIops          float64
+    WriteIops         float64
+    TotalIops         float64
+    AvgReadLatencyMs  float64
+    AvgWriteLatencyMs float64
+    Utilization       float64
+}
+
 
 /*   统计类型指标   */
 // CPULoadData CPU负载数据
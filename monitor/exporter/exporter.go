@@ -17,6 +17,7 @@ import (
 type EBPFExporter struct {
     registry *prometheus.Registry
     server   *http.Server
+    mux      *http.ServeMux
     config   *Config
     
     // 指标收集器
@@ -89,6 +90,7 @@ func (e *EBPFExporter) Start() error {
     
     // 设置HTTP路由
     mux := http.NewServeMux()
+    e.mux = mux
     mux.Handle(e.config.MetricsPath, e.metricsHandler())
     mux.Handle("/health", e.healthHandler())
     mux.Handle("/", e.rootHandler())
@@ -183,6 +185,18 @@ func (e *EBPFExporter) rootHandler() http.Handler {
     })
 }
 
+// Handle 在已启动的 exporter 上注册额外的 HTTP 端点（如软中断超时事件）
+func (e *EBPFExporter) Handle(pattern string, handler http.Handler) error {
+    e.mu.Lock()
+    defer e.mu.Unlock()
+
+    if e.mux == nil {
+        return fmt.Errorf("exporter is not running")
+    }
+    e.mux.Handle(pattern, handler)
+    return nil
+}
+
 // GetRegistry 获取指标注册表（用于外部注册指标）
 func (e *EBPFExporter) GetRegistry() *prometheus.Registry {
     return e.registry
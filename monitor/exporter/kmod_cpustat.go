@@ -0,0 +1,163 @@
+package exporter
+
+import (
+    "fmt"
+    "os"
+    "runtime"
+    "strconv"
+    "sync/atomic"
+    "syscall"
+    "unsafe"
+
+    "github.com/prometheus/client_golang/prometheus"
+)
+
+// cpu_stat_monitor_kmod 的环形缓冲区（布局见 plain_monitor/cpu_stat_ring.h）
+// 设备只打开、映射一次；持有的 fd 同时让内核模块在 exporter 运行期间无法被卸载，映射不会失效。
+// 每次更新直接从映射内存按 C 布局原地解码到预分配的缓冲区，并复用预先解析好的 Gauge，不产生内存分配。
+const (
+    CpuStatDevicePath = "/dev/cpu_stat_monitor"
+
+    kmodRingMaxRetries      = 1000
+    kmodRingSpinBeforeYield = 64
+)
+
+type CpuStatRing struct {
+    file   *os.File
+    data   []byte
+    header *cpuStatRingHeader
+    stats  []kmodCpuStat        // 最近一次读到的采样，长度 nr_cpus
+    words  []uint64             // stats 的按字视图，用于原子复制
+    gauges [][]prometheus.Gauge // [cpu][CpuStatsNames 下标]，CPU 首次在线时解析
+}
+
+func OpenCpuStatRing(path string) (*CpuStatRing, error) {
+    file, err := os.OpenFile(path, os.O_RDONLY, 0)
+    if err != nil {
+        return nil, fmt.Errorf("fail to open %s: %v", path, err)
+    }
+
+    // 先映射头部，得到环形缓冲区的实际大小
+    headerSize := int(unsafe.Sizeof(cpuStatRingHeader{}))
+    data, err := syscall.Mmap(int(file.Fd()), 0, headerSize, syscall.PROT_READ, syscall.MAP_SHARED)
+    if err != nil {
+        file.Close()
+        return nil, fmt.Errorf("Mmap failed: %v", err)
+    }
+    header := *(*cpuStatRingHeader)(unsafe.Pointer(&data[0]))
+    syscall.Munmap(data)
+
+    if header.Magic != cpuStatRingMagic || header.Version != cpuStatRingVersion ||
+        uintptr(header.StatSize) != unsafe.Sizeof(kmodCpuStat{}) || header.NrSlots == 0 {
+        file.Close()
+        return nil, fmt.Errorf("unexpected cpu_stat ring layout: magic %#x version %d stat_size %d",
+            header.Magic, header.Version, header.StatSize)
+    }
+    if uintptr(header.SlotSize) < unsafe.Sizeof(cpuStatSlotHeader{})+uintptr(header.NrCpus)*unsafe.Sizeof(kmodCpuStat{}) {
+        file.Close()
+        return nil, fmt.Errorf("cpu_stat ring slot too small: %d", header.SlotSize)
+    }
+
+    ringSize := int(header.SlotOffset) + int(header.SlotSize)*int(header.NrSlots)
+    data, err = syscall.Mmap(int(file.Fd()), 0, ringSize, syscall.PROT_READ, syscall.MAP_SHARED)
+    if err != nil {
+        file.Close()
+        return nil, fmt.Errorf("Mmap failed: %v", err)
+    }
+
+    stats := make([]kmodCpuStat, header.NrCpus)
+    r := &CpuStatRing{
+        file:   file,
+        data:   data,
+        header: (*cpuStatRingHeader)(unsafe.Pointer(&data[0])),
+        stats:  stats,
+        gauges: make([][]prometheus.Gauge, header.NrCpus),
+    }
+    if len(stats) > 0 {
+        r.words = unsafe.Slice((*uint64)(unsafe.Pointer(&stats[0])), len(stats)*int(unsafe.Sizeof(kmodCpuStat{}))/8)
+    }
+    return r, nil
+}
+
+func (r *CpuStatRing) Close() {
+    if r.data != nil {
+        syscall.Munmap(r.data)
+        r.data = nil
+        r.header = nil
+    }
+    if r.file != nil {
+        r.file.Close()
+        r.file = nil
+    }
+}
+
+func (r *CpuStatRing) word(offset uintptr) *uint64 {
+    return (*uint64)(unsafe.Pointer(&r.data[offset]))
+}
+
+// ReadLatest 按 seqlock 规则把最新一代采样复制到 r.stats，返回其代数
+func (r *CpuStatRing) ReadLatest() (uint64, error) {
+    h := r.header
+    slotHeaderSize := unsafe.Sizeof(cpuStatSlotHeader{})
+
+    for retries := 0; retries <= kmodRingMaxRetries; retries++ {
+        if retries > 0 && retries%kmodRingSpinBeforeYield == 0 {
+            runtime.Gosched()
+        }
+        generation := atomic.LoadUint64(&h.Generation)
+        if generation == 0 {
+            return 0, fmt.Errorf("cpu_stat ring has no sample yet")
+        }
+        slot := uintptr(h.SlotOffset) + uintptr(generation%uint64(h.NrSlots))*uintptr(h.SlotSize)
+        seq := atomic.LoadUint64(r.word(slot))
+        if seq&1 != 0 {
+            continue
+        }
+        data := slot + slotHeaderSize
+        for i := range r.words {
+            r.words[i] = atomic.LoadUint64(r.word(data + uintptr(i)*8))
+        }
+        // slot 的 generation 不符说明读的过程中该 slot 已被更新的采样覆盖
+        if atomic.LoadUint64(r.word(slot+8)) == generation && atomic.LoadUint64(r.word(slot)) == seq {
+            return generation, nil
+        }
+    }
+    return 0, fmt.Errorf("cpu_stat ring kept changing while reading")
+}
+
+func (r *CpuStatRing) cpuGauges(cpu int) []prometheus.Gauge {
+    if r.gauges[cpu] == nil {
+        cpuLabel := strconv.Itoa(cpu)
+        gauges := make([]prometheus.Gauge, len(CpuStatsNames))
+        for i, name := range CpuStatsNames {
+            gauges[i] = cpuStatNumbers.WithLabelValues(name, cpuLabel, "111")
+        }
+        r.gauges[cpu] = gauges
+    }
+    return r.gauges[cpu]
+}
+
+// UpdateMetrics 读取最新采样并更新 ebpf_cpu_stat，字段顺序与 CpuStatsNames 一致
+func (r *CpuStatRing) UpdateMetrics() error {
+    if _, err := r.ReadLatest(); err != nil {
+        return err
+    }
+    for cpu := range r.stats {
+        stat := &r.stats[cpu]
+        if stat.Online == 0 {
+            continue
+        }
+        g := r.cpuGauges(cpu)
+        g[0].Set(float64(stat.User))
+        g[1].Set(float64(stat.Nice))
+        g[2].Set(float64(stat.System))
+        g[3].Set(float64(stat.Idle))
+        g[4].Set(float64(stat.Iowait))
+        g[5].Set(float64(stat.Irq))
+        g[6].Set(float64(stat.Softirq))
+        g[7].Set(float64(stat.Steal))
+        g[8].Set(float64(stat.Guest))
+        g[9].Set(float64(stat.Guest_nice))
+    }
+    return nil
+}
@@ -0,0 +1,132 @@
+package exporter
+
+import (
+    "fmt"
+
+    "github.com/cilium/ebpf"
+    "github.com/cilium/ebpf/link"
+)
+
+// MemStallMonitor 读取 mem_stall_monitor 按 (cgroup, 停顿类型) 累计的直接回收与直接规整停顿直方图
+type MemStallMonitor struct {
+    monitor     *Monitor
+    histMap     *ebpf.Map
+    countersMap *ebpf.Map
+
+    cgroups *cgroupPaths
+}
+
+// attachMemStallMonitoring 加载 mem_stall_monitor.bpf.o 并挂载到 vmscan 与 compaction 的 begin/end tracepoint
+func attachMemStallMonitoring(codePath string) (*MemStallMonitor, error) {
+    spec, err := ebpf.LoadCollectionSpec(codePath + ".output/mem_stall_monitor.bpf.o")
+    if err != nil {
+        return nil, fmt.Errorf("加载eBPF集合规范失败: %v", err)
+    }
+    collection, err := ebpf.NewCollection(spec)
+    if err != nil {
+        return nil, fmt.Errorf("创建eBPF集合失败: %v", err)
+    }
+    monitor := &Monitor{
+        coll: collection,
+    }
+    cleanup := func() {
+        for _, l := range monitor.links {
+            l.Close()
+        }
+        collection.Close()
+    }
+
+    for _, name := range []string{
+        "handle_direct_reclaim_begin", "handle_direct_reclaim_end",
+        "handle_memcg_reclaim_begin", "handle_memcg_reclaim_end",
+        "handle_compaction_begin", "handle_compaction_end",
+    } {
+        prog, ok := collection.Programs[name]
+        if !ok {
+            cleanup()
+            return nil, fmt.Errorf("找不到 %s 程序", name)
+        }
+        l, err := link.AttachTracing(link.TracingOptions{Program: prog})
+        if err != nil {
+            cleanup()
+            return nil, fmt.Errorf("附加 %s 失败: %v", name, err)
+        }
+        monitor.links = append(monitor.links, l)
+    }
+
+    m := &MemStallMonitor{
+        monitor:     monitor,
+        histMap:     collection.Maps["mem_stall_hist"],
+        countersMap: collection.Maps["mem_stall_counters"],
+        cgroups: newCgroupPaths(func(path string) {
+            for _, stall := range MemStallTypeNames {
+                MemStallLatency.Delete(path, stall, "111")
+                memStallPages.Delete(path, stall, "111")
+            }
+        }),
+    }
+    if m.histMap == nil || m.countersMap == nil {
+        cleanup()
+        return nil, fmt.Errorf("找不到 mem_stall_monitor 的映射")
+    }
+    monitor.statsMap = m.histMap
+    return m, nil
+}
+
+// Update 把各 CPU 求和后的直方图交给 MemStallLatency，回收的页数交给 memStallPages
+func (m *MemStallMonitor) Update() error {
+    var key memStallKey
+    var perCPU []memStallHist
+    var total memStallHist
+    var gone []memStallKey
+
+    m.cgroups.begin()
+    iter := m.histMap.Iterate()
+    for iter.Next(&key, &perCPU) {
+        path, ok := m.cgroups.lookup(key.Cgroup)
+        if !ok {
+            gone = append(gone, key)
+            continue
+        }
+        stall := "unknown"
+        if int(key.Type) < len(MemStallTypeNames) {
+            stall = MemStallTypeNames[key.Type]
+        }
+
+        total = memStallHist{}
+        for cpu := range perCPU {
+            h := &perCPU[cpu]
+            total.Count += h.Count
+            total.SumNs += h.SumNs
+            total.Pages += h.Pages
+            for slot := range h.Slots {
+                total.Slots[slot] += h.Slots[slot]
+            }
+        }
+        MemStallLatency.Set(total.Count, total.SumNs, total.Slots[:], path, stall, "111")
+        if key.Type != memStallCompaction {
+            memStallPages.Set(total.Pages, path, stall, "111")
+        }
+    }
+    if err := iter.Err(); err != nil {
+        return fmt.Errorf("遍历 mem_stall_hist 出错: %v", err)
+    }
+
+    // 已删除的 cgroup 从 map 中移除，给新的 cgroup 腾出位置
+    for i := range gone {
+        m.histMap.Delete(&gone[i])
+    }
+
+    var counters []uint64
+    for i, name := range MemStallCounterNames {
+        if err := m.countersMap.Lookup(uint32(i), &counters); err != nil {
+            return fmt.Errorf("读取 mem_stall_counters 失败: %v", err)
+        }
+        var sum uint64
+        for _, v := range counters {
+            sum += v
+        }
+        memStallDrops.Set(sum, name, "111")
+    }
+    return nil
+}
@@ -2,22 +2,24 @@ package exporter
 /*
 #cgo CFLAGS: -I${SRCDIR}/../ebpf
 #cgo LDFLAGS: -lmonitor -lelf -lz
+#include <stdlib.h>
 #include "net_monitor.h"
 #include "cpu_stat_monitor.h"
+#include "tcp_retrans_monitor.h"
 */
 import "C"
 import "C"
 import (
     "fmt"
     "log"
+    "net"
+    "net/http"
     "os"
-    "bytes"
-    "encoding/binary"
     "strconv"
+    "strings"
     "syscall"
     _ "reflect"
     "unsafe"
-    "math"
 
     "github.com/cilium/ebpf"
     "github.com/cilium/ebpf/link"
@@ -25,14 +27,6 @@ import (
     "github.com/prometheus/client_golang/prometheus"
 )
 
-var buckets []float64
-// 初始化桶边界
-func init() {
-    for i := 1; i <= 24; i++ {
-        buckets = append(buckets, float64((int(1) << i) - 1))
-    }
-}
-
 // 定义所有eBPF监控指标
 var (
     cpuStatNumbers = prometheus.NewGaugeVec(
@@ -51,29 +45,188 @@ var (
         []string{"traffic_type", "node"},
     )
 
-    SoftirqTimes = prometheus.NewGaugeVec(
+    networkBytes = newConstCounterVec(
+        "ebpf_network_bytes_total",
+        "bytes seen by tc per interface, direction and protocol",
+        []string{"interface", "direction", "l3", "l4", "node"},
+    )
+
+    networkPackets = newConstCounterVec(
+        "ebpf_network_packets_total",
+        "packets seen by tc per interface, direction and protocol",
+        []string{"interface", "direction", "l3", "l4", "node"},
+    )
+
+    networkIngressMode = prometheus.NewGaugeVec(
         prometheus.GaugeOpts{
-            Name: "ebpf_softirqs_operations_times",
-            Help: "software interrupt number",
+            Name: "ebpf_network_ingress_mode",
+            Help: "ingress hook used per interface (xdp, xdp-generic or tc), value is always 1",
         },
-        []string{"softirq_type", "cpu", "node"}, 
+        []string{"interface", "mode", "node"},
     )
 
-    SoftirqNumbers = prometheus.NewGaugeVec(
+    topFlowBytes = prometheus.NewGaugeVec(
         prometheus.GaugeOpts{
-            Name: "ebpf_softirqs_operations_total",
-            Help: "software interrupt number",
+            Name: "ebpf_network_top_flow_bytes_per_second",
+            Help: "top flows by bytes over the last update interval (count-min sketch estimate)",
         },
-        []string{"softirq_type", "cpu", "node"}, 
+        []string{"src", "dst", "sport", "dport", "proto", "node"},
     )
 
-    TcpStatMetric = prometheus.NewHistogramVec(
-        prometheus.HistogramOpts{
-            Name:    "ebpf_tcp_conn_delay",
-            Help:    "software interrupt number",
-            Buckets: buckets,
-        }, 
-        []string{"node"},// 标签维度
+    topFlowPackets = prometheus.NewGaugeVec(
+        prometheus.GaugeOpts{
+            Name: "ebpf_network_top_flow_packets_per_second",
+            Help: "top flows by packets over the last update interval (count-min sketch estimate)",
+        },
+        []string{"src", "dst", "sport", "dport", "proto", "node"},
+    )
+
+    // 每个 CPU 的 kernel_cpustat 与 softirq_stats 在抓取时读取，见 bpf_scrape.go
+    BPFScrape = newBpfScrapeCollector()
+
+    TcpRetrans = newTcpRetransCollector()
+
+    RunqLatency = newLog2Histogram(
+        "ebpf_runq_latency_seconds",
+        "time from wakeup (or preemption) to running, by the cpu whose run queue the task waited on",
+        []string{"cpu", "node"}, runqHistSlots, 1e-9,
+    )
+
+    CgroupRunqLatency = newLog2Histogram(
+        "ebpf_cgroup_runq_latency_seconds",
+        "time from wakeup (or preemption) to running, by cgroup v2 path (RUNQLAT_PER_CGROUP=1)",
+        []string{"cgroup", "node"}, runqHistSlots, 1e-9,
+    )
+
+    BlockIOLatency = newLog2Histogram(
+        "ebpf_disk_io_latency_seconds",
+        "block request latency from issue to the driver until completion, by device and operation",
+        []string{"device", "op", "node"}, blockLatSlots, 1e-9,
+    )
+
+    BlockQueueDepth = newLog2Histogram(
+        "ebpf_disk_queue_depth",
+        "requests in flight on the device when a request is issued (including itself), by device and operation",
+        []string{"device", "op", "node"}, blockDepthSlots, 1,
+    )
+
+    MemStallLatency = newLog2Histogram(
+        "ebpf_memory_stall_seconds",
+        "time an allocating task spent in direct reclaim, memcg limit reclaim or direct compaction, by cgroup v2 path",
+        []string{"cgroup", "type", "node"}, memStallHistSlots, 1e-9,
+    )
+
+    memStallPages = newConstCounterVec(
+        "ebpf_memory_stall_reclaimed_pages_total",
+        "pages reclaimed by direct and memcg limit reclaim in allocating tasks, by cgroup v2 path",
+        []string{"cgroup", "type", "node"},
+    )
+
+    memStallDrops = newConstCounterVec(
+        "ebpf_memory_stall_dropped_total",
+        "memory stalls not recorded: task storage allocation failures and (cgroup, type) pairs beyond the histogram table",
+        []string{"reason", "node"},
+    )
+
+    blockIODrops = newConstCounterVec(
+        "ebpf_disk_io_dropped_total",
+        "block requests not recorded: in-flight table full or more devices than the histogram table holds",
+        []string{"reason", "node"},
+    )
+
+    runqEvents = newConstCounterVec(
+        "ebpf_runq_dropped_total",
+        "run queue latency samples not recorded: task storage allocation failures and cgroups beyond the cgroup table",
+        []string{"reason", "node"},
+    )
+
+    softirqOutlierEvents = prometheus.NewCounterVec(
+        prometheus.CounterOpts{
+            Name: "ebpf_softirq_outlier_events_total",
+            Help: "softirqs that ran longer than the outlier threshold",
+        },
+        []string{"softirq_type", "node"},
+    )
+
+    softirqOutlierDrops = newConstCounterVec(
+        "ebpf_softirq_outlier_drops_total",
+        "softirq outlier events dropped because the ring buffer was full",
+        []string{"node"},
+    )
+
+    softirqOutlierThreshold = prometheus.NewGaugeVec(
+        prometheus.GaugeOpts{
+            Name: "ebpf_softirq_outlier_threshold_seconds",
+            Help: "current softirq outlier threshold, 0 means disabled",
+        },
+        []string{"node"},
+    )
+
+    TcpStatMetric = newLog2Histogram(
+        "ebpf_tcp_conn_delay",
+        "passive TCP handshake latency in microseconds by local port (\"other\" for ports not configured)",
+        []string{"port", "node"}, tcpHistSlots, 1,
+    )
+
+    tcpHandshakeEvents = newConstCounterVec(
+        "ebpf_tcp_handshake_events_total",
+        "tcp_stat_monitor bookkeeping: tracked handshakes, start map failures, handshakes without a start time (LRU eviction or SYN cookies) and latencies beyond the last bucket",
+        []string{"event", "node"},
+    )
+
+    // plain_monitord 共享内存快照中的指标
+    plainMemInfo = prometheus.NewGaugeVec(
+        prometheus.GaugeOpts{
+            Name: "plain_meminfo",
+            Help: "/proc/meminfo fields published by plain_monitord",
+        },
+        []string{"meminfo_type", "node"},
+    )
+
+    plainCpuLoad = prometheus.NewGaugeVec(
+        prometheus.GaugeOpts{
+            Name: "plain_cpu_load",
+            Help: "load average published by plain_monitord; load_1s/10s/60s are EWMAs of procs_running + procs_blocked sampled from /proc/stat",
+        },
+        []string{"load_type", "node"},
+    )
+
+    plainDiskStat = prometheus.NewGaugeVec(
+        prometheus.GaugeOpts{
+            Name: "plain_disk_stat",
+            Help: "per-device disk statistics published by plain_monitord",
+        },
+        []string{"disk_stat_type", "device", "node"},
+    )
+
+    plainNumaStat = prometheus.NewGaugeVec(
+        prometheus.GaugeOpts{
+            Name: "plain_numa_stat",
+            Help: "per-NUMA-node meminfo (kB), numastat and vmstat counters published by plain_monitord",
+        },
+        []string{"numa_node", "stat", "node"},
+    )
+
+    plainPsiEvents = newConstCounterVec(
+        "plain_psi_trigger_events_total",
+        "PSI trigger events seen by plain_monitord per cgroup (empty for system-wide), resource and some/full",
+        []string{"cgroup", "resource", "kind", "node"},
+    )
+
+    plainPsiLastEvent = prometheus.NewGaugeVec(
+        prometheus.GaugeOpts{
+            Name: "plain_psi_trigger_last_event_timestamp_seconds",
+            Help: "unix time of the latest PSI trigger event, 0 if the trigger never fired",
+        },
+        []string{"cgroup", "resource", "kind", "node"},
+    )
+
+    plainPsiStall = prometheus.NewGaugeVec(
+        prometheus.GaugeOpts{
+            Name: "plain_psi_stall",
+            Help: "PSI avg10/avg60/avg300 (percent) and total (microseconds) read when the trigger last fired or was registered",
+        },
+        []string{"cgroup", "resource", "kind", "stat", "node"},
     )
 
     // Exporter自身指标
@@ -97,11 +250,35 @@ var (
 // createEBPFMetrics 创建所有eBPF指标集合
 func createEBPFMetrics() []prometheus.Collector {
     return []prometheus.Collector{
-        cpuStatNumbers,
+        BPFScrape,
         networkTraffic,
-        SoftirqNumbers,
-        SoftirqTimes,
+        networkBytes,
+        networkPackets,
+        networkIngressMode,
+        topFlowBytes,
+        topFlowPackets,
+        softirqOutlierEvents,
+        softirqOutlierDrops,
+        softirqOutlierThreshold,
         TcpStatMetric,
+        tcpHandshakeEvents,
+        TcpRetrans,
+        RunqLatency,
+        CgroupRunqLatency,
+        runqEvents,
+        plainMemInfo,
+        plainCpuLoad,
+        plainDiskStat,
+        plainNumaStat,
+        plainPsiEvents,
+        plainPsiLastEvent,
+        plainPsiStall,
+        BlockIOLatency,
+        BlockQueueDepth,
+        blockIODrops,
+        MemStallLatency,
+        memStallPages,
+        memStallDrops,
         ExporterBuildInfo,
         ExporterScrapeDuration,
     }
@@ -110,9 +287,28 @@ func createEBPFMetrics() []prometheus.Collector {
 // 指标更新函数
 type MetricUpdater struct {
     softirqMonitor *Monitor
-    cpuStatMap *ebpf.Map
+    softirqOutliers *SoftirqOutlierStream
+    cpuStatIter bool                                   // cpu_stat 迭代器可用；否则从内核模块读取
+    kmodCpuStat *CpuStatRing
     trafficMap *ebpf.Map
+    topFlows *TopFlows
+    ifaceNames map[uint32]string
     tcpMonitor *Monitor
+    tcpRetrans *TcpRetransMonitor
+    runqlat *RunqlatMonitor
+    blockIO *BlockIOMonitor
+    memStall *MemStallMonitor
+    tcpPorts []uint16                                  // 单独统计握手延迟的本端端口，下标即 hist 的行号
+    plainSnapshot *PlainSnapshot
+    plainDisks map[string]bool                         // 上一次导出 plain_disk_stat 的设备名
+    plainPsi map[plainPsiLabels]bool                   // 上一次导出 plain_psi_* 的有效触发器
+}
+
+// plain_psi_* 序列中标识一个触发器的标签
+type plainPsiLabels struct {
+    cgroup   string
+    resource string
+    kind     string
 }
 
 type Monitor struct {
@@ -133,27 +329,86 @@ func NewMetricUpdater() (*MetricUpdater, error) {
     if err != nil {
         return nil, fmt.Errorf("NewMetricUpdater失败: %v", err)
     }
-    cpuStatMap, err := attachCpuStatMonitoring()
+    softirqOutliers, err := newSoftirqOutlierStream(softirqMonitor.coll)
     if err != nil {
+        log.Println("softirq 超时事件流不可用: ", err)
+        softirqOutliers = nil
+    }
+    cpuStatIter := true
+    if err := attachCpuStatMonitoring(); err != nil {
         log.Println("加载ebpf失败,尝试kmodule获取: ", err)
-        cpuStatMap = nil
+        cpuStatIter = false
     }
     trafficMap, err := attachTrafficMonitoring()
     if err != nil {
         return nil, fmt.Errorf("NewMetricUpdater失败: %v", err)
     }
+    topFlows, err := attachTopFlows()
+    if err != nil {
+        log.Println("大流量检测不可用: ", err)
+        topFlows = nil
+    }
     tcpMonitor, err := attachTcpStatMonitoring(codePath)
     if err != nil {
         return nil, fmt.Errorf("NewTcpStatMonitoring失败: %v", err)
     }
+    tcpRetrans, err := attachTcpRetransMonitoring()
+    if err != nil {
+        log.Println("TCP 重传与 RTT 统计不可用: ", err)
+        tcpRetrans = nil
+    }
+    // RUNQLAT_PER_CGROUP=1 时另外按 cgroup 统计运行队列延迟
+    runqlat, err := attachRunqlatMonitoring(codePath, os.Getenv("RUNQLAT_PER_CGROUP") == "1")
+    if err != nil {
+        log.Println("运行队列延迟统计不可用: ", err)
+        runqlat = nil
+    }
+    blockIO, err := attachBlockIOMonitoring(codePath)
+    if err != nil {
+        log.Println("块设备 I/O 延迟统计不可用: ", err)
+        blockIO = nil
+    }
+    memStall, err := attachMemStallMonitoring(codePath)
+    if err != nil {
+        log.Println("直接回收与规整停顿统计不可用: ", err)
+        memStall = nil
+    }
+
+    // plain_monitord 可能晚于 exporter 启动，映射失败时在 UpdatePlainMetrics 中重试
+    plainSnapshot, err := OpenPlainSnapshot(plainSnapshotPath())
+    if err != nil {
+        log.Println("plain_monitord 快照暂不可用: ", err)
+        plainSnapshot = nil
+    }
+
+    if cpuStatIter {
+        BPFScrape.SetSources(readCpuStatIter, softirqMonitor.statsMap)
+    } else {
+        BPFScrape.SetSources(nil, softirqMonitor.statsMap)
+    }
 
     updater := &MetricUpdater{
         softirqMonitor: softirqMonitor,
-        cpuStatMap: cpuStatMap,
+        softirqOutliers: softirqOutliers,
+        cpuStatIter: cpuStatIter,
         trafficMap: trafficMap,
+        topFlows: topFlows,
+        ifaceNames: make(map[uint32]string),
         tcpMonitor: tcpMonitor,
+        tcpRetrans: tcpRetrans,
+        runqlat: runqlat,
+        blockIO: blockIO,
+        memStall: memStall,
+        plainSnapshot: plainSnapshot,
     }
     
+    // 逗号分隔的本端端口，如 "80,443"，握手延迟按这些端口分别统计
+    if ports, err := parseTcpPorts(os.Getenv("TCP_CONN_DELAY_PORTS")); err != nil {
+        log.Println("TCP_CONN_DELAY_PORTS 无效: ", err)
+    } else if err := updater.SetTcpConnDelayPorts(ports); err != nil {
+        log.Println("配置握手延迟端口失败: ", err)
+    }
+
     log.Println("eBPF程序成功加载并附加到软中断tracepoints")
     return updater, nil
 }
@@ -224,29 +479,59 @@ func attachSoftirqMonitoring(codePath string) (*Monitor, error) {
     return monitor, nil
 }
 
-func attachCpuStatMonitoring() (*ebpf.Map, error) {
-  if C.init_cpu_stat_monitor() != 0 {
-        return nil, fmt.Errorf("failed to initialize eBPF programs")
+func attachCpuStatMonitoring() error {
+    if err := C.init_cpu_stat_monitor(); err != 0 {
+        return fmt.Errorf("failed to initialize cpu_stat iterator: %d", int(err))
     }
+    return nil
+}
 
-    cpuStatfd := C.get_cpustats_map_fd()
-	if cpuStatfd == -1 {
-		return nil, fmt.Errorf("[attachCpuStatMonitoring]failed to get mapFd")
-	}
-    fmt.Println("get cpustat fd: ", cpuStatfd)
-    cpuStatMap, err := ebpf.NewMapFromFD(int(cpuStatfd))
-    if err != nil {
-        return nil, fmt.Errorf("failed to create syscall map: %v", err)
+// readCpuStatIter 读取一次 cpu_stat 迭代器，返回写入 buf 的记录数（每个在线 CPU 一条，按 CPU 号递增）
+func readCpuStatIter(buf []cpu_stat) (int, error) {
+    if len(buf) == 0 {
+        return 0, nil
     }
-
-    return cpuStatMap, nil;
+    n := C.read_cpu_stats((*C.struct_cpu_stat)(unsafe.Pointer(&buf[0])), C.int(len(buf)))
+    if n < 0 {
+        return 0, fmt.Errorf("读取 cpu_stat 迭代器失败: %v", syscall.Errno(-n))
+    }
+    return int(n), nil
 }
 
 func attachTrafficMonitoring() (*ebpf.Map, error) {
-    if C.init_net_monitor() != 0 {
+    // 逗号分隔的网卡列表，如 "bond0,bond0.100"；未设置时只挂载 eth0
+    ifaces := C.CString(os.Getenv("NET_MONITOR_INTERFACES"))
+    defer C.free(unsafe.Pointer(ifaces))
+    // 入向挂载方式：auto（默认，原生 XDP 不可用时回退 tc）、xdp、xdp-generic、tc
+    ingressMode := C.NET_INGRESS_AUTO
+    if v := os.Getenv("NET_MONITOR_INGRESS_MODE"); v != "" {
+        ingressMode = -1
+        for i, name := range NetIngressModeNames {
+            if name == v {
+                ingressMode = i
+            }
+        }
+        if ingressMode < 0 {
+            return nil, fmt.Errorf("unknown NET_MONITOR_INGRESS_MODE %q", v)
+        }
+    }
+    if C.init_net_monitor(ifaces, C.int(ingressMode)) != 0 {
         return nil, fmt.Errorf("failed to initialize eBPF programs")
     }
 
+    for i := 0; i < int(C.net_monitor_attachment_count()); i++ {
+        var ifindex, mode C.int
+        if C.net_monitor_attachment(C.int(i), &ifindex, &mode) != 0 || int(mode) >= len(NetIngressModeNames) {
+            continue
+        }
+        name := strconv.Itoa(int(ifindex))
+        if iface, err := net.InterfaceByIndex(int(ifindex)); err == nil {
+            name = iface.Name
+        }
+        log.Printf("网卡 %s 入向使用 %s", name, NetIngressModeNames[mode])
+        networkIngressMode.WithLabelValues(name, NetIngressModeNames[mode], "111").Set(1)
+    }
+
     netfd := C.net_monitor_get_packetsinfo_fd()
 	if netfd == 0 {
 		return nil, fmt.Errorf("[attachTrafficMonitoring]failed to get mapFd")
@@ -259,6 +544,85 @@ func attachTrafficMonitoring() (*ebpf.Map, error) {
     return trafficMap, nil;
 }
 
+// envInt 读取整数环境变量，未设置或无效时返回默认值
+func envInt(name string, def int) int {
+    if v := os.Getenv(name); v != "" {
+        if parsed, err := strconv.Atoi(v); err == nil {
+            return parsed
+        }
+        log.Printf("%s=%q 无效，使用默认值 %d", name, v, def)
+    }
+    return def
+}
+
+// attachTcpRetransMonitoring 加载 tcp_retrans_monitor。
+// TCP_RETRANS_KEY=subnet|port 选择聚合维度，TCP_RETRANS_IPV4_PREFIX/TCP_RETRANS_IPV6_PREFIX 为子网前缀，
+// TCP_RTT_SAMPLE_SHIFT 为 srtt 采样率（每 2^n 个 ACK 一次）
+func attachTcpRetransMonitoring() (*TcpRetransMonitor, error) {
+    mode := C.TCP_PEER_BY_SUBNET
+    if v := os.Getenv("TCP_RETRANS_KEY"); v != "" {
+        mode = -1
+        for i, name := range TcpPeerModeNames {
+            if name == v {
+                mode = i
+            }
+        }
+        if mode < 0 {
+            return nil, fmt.Errorf("unknown TCP_RETRANS_KEY %q", v)
+        }
+    }
+    ipv4Prefix := envInt("TCP_RETRANS_IPV4_PREFIX", 24)
+    ipv6Prefix := envInt("TCP_RETRANS_IPV6_PREFIX", 64)
+    sampleShift := envInt("TCP_RTT_SAMPLE_SHIFT", 4)
+    if ipv4Prefix < 1 || ipv4Prefix > 32 || ipv6Prefix < 1 || ipv6Prefix > 128 {
+        return nil, fmt.Errorf("invalid subnet prefix /%d /%d", ipv4Prefix, ipv6Prefix)
+    }
+
+    if C.init_tcp_retrans_monitor(C.int(mode), C.int(ipv4Prefix), C.int(ipv6Prefix), C.int(sampleShift)) != 0 {
+        return nil, fmt.Errorf("failed to initialize tcp_retrans_monitor")
+    }
+    statsMap, err := ebpf.NewMapFromFD(int(C.tcp_retrans_get_stats_fd()))
+    if err != nil {
+        return nil, fmt.Errorf("failed to create tcp_peer_stats map: %v", err)
+    }
+    dropsMap, err := ebpf.NewMapFromFD(int(C.tcp_retrans_get_drops_fd()))
+    if err != nil {
+        return nil, fmt.Errorf("failed to create tcp_peer_drops map: %v", err)
+    }
+    return &TcpRetransMonitor{
+        statsMap:   statsMap,
+        dropsMap:   dropsMap,
+        ipv4Prefix: ipv4Prefix,
+        ipv6Prefix: ipv6Prefix,
+    }, nil
+}
+
+// attachTopFlows 开启 net_monitor 的大流量检测；NET_MONITOR_TOP_FLOWS 为导出的流数，未设置或为0时不开启，返回 nil
+func attachTopFlows() (*TopFlows, error) {
+    topN := 0
+    if v := os.Getenv("NET_MONITOR_TOP_FLOWS"); v != "" {
+        parsed, err := strconv.Atoi(v)
+        if err != nil || parsed < 0 {
+            return nil, fmt.Errorf("invalid NET_MONITOR_TOP_FLOWS %q", v)
+        }
+        topN = parsed
+    }
+    if topN == 0 {
+        return nil, nil
+    }
+
+    fds := []C.int{C.net_monitor_get_flow_config_fd(), C.net_monitor_get_flow_sketch_fd(), C.net_monitor_get_flow_topk_fd()}
+    maps := make([]*ebpf.Map, len(fds))
+    for i, fd := range fds {
+        m, err := ebpf.NewMapFromFD(int(fd))
+        if err != nil {
+            return nil, fmt.Errorf("failed to create flow map: %v", err)
+        }
+        maps[i] = m
+    }
+    return newTopFlows(maps[0], maps[1], maps[2], topN)
+}
+
 func attachTcpStatMonitoring(codePath string) (*Monitor, error) {    
     collectionSpec, err := ebpf.LoadCollectionSpec(codePath + ".output/tcp_stat_monitor.bpf.o")
     if err != nil {
@@ -275,42 +639,41 @@ func attachTcpStatMonitoring(codePath string) (*Monitor, error) {
     monitor := &Monitor{
         coll: collection,
     }
-	cleanup := func() {
-		for _, l := range monitor.links {
-			l.Close()
-		}
-	}
-	// --- 附加 KProbes (已修正) ---
-	probes := map[string]string{
-		"kp_inet_csk_reqsk_queue_hash_add": "inet_csk_reqsk_queue_hash_add",
-		// "kp_tcp_v6_conn_request": "tcp_v6_conn_request",
-		"kp_tcp_set_state":       "tcp_set_state",
-	}
-
-	for progName, kernelFunc := range probes {
-		prog, exists := collection.Programs[progName]
-		if !exists {
-			cleanup() // 关闭之前已创建的 links
-			collection.Close()
-			return nil, fmt.Errorf("找不到 %s 程序", progName)
-		}
-
-		l, err := link.Kprobe(kernelFunc, prog, nil)
-		if err != nil {
-			cleanup() // 关闭之前已创建的 links
-			collection.Close()
-			return nil, fmt.Errorf("附加 %s 到 %s 失败: %v", progName, kernelFunc, err)
-		}
-		monitor.links = append(monitor.links, l)
-	}
-
-    hashMap, ok := collection.Maps["hist"]
-    if !ok {
-        // 关闭已创建的links
+    cleanup := func() {
         for _, l := range monitor.links {
             l.Close()
         }
         collection.Close()
+    }
+
+    // SYN 时间：fentry 直接读取请求套接字；建连：sock:inet_sock_set_state tracepoint
+    prog, ok := collection.Programs["fentry_reqsk_queue_hash_add"]
+    if !ok {
+        cleanup()
+        return nil, fmt.Errorf("找不到 fentry_reqsk_queue_hash_add 程序")
+    }
+    l, err := link.AttachTracing(link.TracingOptions{Program: prog})
+    if err != nil {
+        cleanup()
+        return nil, fmt.Errorf("附加 fentry/inet_csk_reqsk_queue_hash_add 失败: %v", err)
+    }
+    monitor.links = append(monitor.links, l)
+
+    prog, ok = collection.Programs["handle_inet_sock_set_state"]
+    if !ok {
+        cleanup()
+        return nil, fmt.Errorf("找不到 handle_inet_sock_set_state 程序")
+    }
+    l, err = link.Tracepoint("sock", "inet_sock_set_state", prog, nil)
+    if err != nil {
+        cleanup()
+        return nil, fmt.Errorf("附加 sock:inet_sock_set_state 失败: %v", err)
+    }
+    monitor.links = append(monitor.links, l)
+
+    hashMap, ok := collection.Maps["hist"]
+    if !ok {
+        cleanup()
         return nil, fmt.Errorf("找不到hist映射")
     }
     monitor.statsMap = hashMap
@@ -319,53 +682,29 @@ func attachTcpStatMonitoring(codePath string) (*Monitor, error) {
 }
 
 
-// UpdateSoftirqMetrics 更新软中断指标
+// UpdateSoftirqMetrics 更新软中断超时事件的丢弃计数；各 CPU 的软中断统计在抓取时读取（BPFScrape）
 func (m *MetricUpdater) UpdateSoftirqMetrics() error {
     if m == nil {
         return fmt.Errorf("MetricUpdater为nil")
     }
-    if m.softirqMonitor.statsMap == nil {
-        return fmt.Errorf("softirqMap为nil")
-    }
-    fmt.Println("[UpdateSoftirqMetrics] update once...")
-    
-    var vec uint32      // 1. Key 现在是 u32 (代表 vec)，Value 是一个 Per-CPU 的切片
-    var perCPUStats []SoftirqStat // 这是接收所有 CPU 数据的切片
-
-    totalEventsProcessed := 0
-    iter := m.softirqMonitor.statsMap.Iterate()
-
-    // 2. 外层循环遍历 Map 中的每一个 key (也就是每个软中断 vec)
-    for iter.Next(&vec, &perCPUStats) {
-        // 3. 内层循环遍历该 key 在所有 CPU 上的值
-        // 切片的索引 `cpuID` 天然地代表了 CPU 的核心号
-        for cpuID, stat := range perCPUStats {
-            // 如果这个 CPU 上确实发生了该类型的软中断 (count > 0)，才上报数据
-            if stat.Count > 0 {
-                irqTypeName := getSoftirqTypeName(vec)
-                cpuIDStr := strconv.Itoa(cpuID) // 将 CPU ID 转换为字符串
-                
-                // 4. 使用 cpuID 和 irqTypeName 作为组合维度上报数据
-                SoftirqNumbers.WithLabelValues(irqTypeName, cpuIDStr, "111").Set(float64(stat.Count))
-                SoftirqTimes.WithLabelValues(irqTypeName, cpuIDStr, "111").Set(float64(stat.MaxTimeNs))
-
-                totalEventsProcessed += int(stat.Count)
-            }
+    if m.softirqOutliers != nil {
+        if err := m.softirqOutliers.UpdateDrops(); err != nil {
+            return err
         }
     }
-    
-    if err := iter.Err(); err != nil {
-        log.Printf("遍历 softirq map 出错: %v", err)
-        return err
-    }
-    
-    if totalEventsProcessed > 0 {
-        log.Printf("总共处理了 %d 个软中断事件", totalEventsProcessed)
-    }
-    
     return nil
 }
 
+// SoftirqOutlierHandler 返回软中断超时事件的 HTTP 处理器，事件流不可用时返回 503
+func (m *MetricUpdater) SoftirqOutlierHandler() http.Handler {
+    if m == nil || m.softirqOutliers == nil {
+        return http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+            http.Error(w, "softirq outlier stream unavailable", http.StatusServiceUnavailable)
+        })
+    }
+    return m.softirqOutliers
+}
+
 // UpdateNetworkTraffic 更新网络吞吐指标
 func (m *MetricUpdater) UpdateTrafficMetrics() error {
     if m == nil {
@@ -375,138 +714,382 @@ func (m *MetricUpdater) UpdateTrafficMetrics() error {
         return fmt.Errorf("trafficMap为nil")
     }
 
-    var key uint32
-    var value ip_packet_info
+    var key trafficKey
+    var perCPU []ip_packet_info
+    var directionBytes [2]uint64
     fmt.Println("[UpdateTrafficMetrics] update once...")
     iter := m.trafficMap.Iterate()
-    for iter.Next(&key, &value) {
-        log.Printf("bytes %d, packets %d", value.Snd_rcv_bytes, value.Snd_rcv_packets)
-        networkTraffic.WithLabelValues(getTrafficName(key), "111").Set(float64(value.Snd_rcv_bytes))
-        networkTraffic.WithLabelValues(getTrafficName(key), "111").Set(float64(value.Snd_rcv_packets))
+    for iter.Next(&key, &perCPU) {
+        // 每个 CPU 各自计数，读取时求和
+        var bytes, packets uint64
+        for _, value := range perCPU {
+            bytes += value.Snd_rcv_bytes
+            packets += value.Snd_rcv_packets
+        }
+        iface := m.interfaceName(key.Ifindex)
+        direction := getTrafficName(uint32(key.Direction))
+        l3, l4 := getTrafficL3Name(key.L3Proto), getTrafficL4Name(key.L4Proto)
+        networkBytes.Set(bytes, iface, direction, l3, l4, "111")
+        networkPackets.Set(packets, iface, direction, l3, l4, "111")
+        if key.Direction < 2 {
+            directionBytes[key.Direction] += bytes
+        }
+    }
+    if err := iter.Err(); err != nil {
+        return fmt.Errorf("遍历 packetsInfo map 出错: %v", err)
+    }
+    for direction, bytes := range directionBytes {
+        networkTraffic.WithLabelValues(getTrafficName(uint32(direction)), "111").Set(float64(bytes))
+    }
+
+    if m.topFlows != nil {
+        if err := m.topFlows.Update(); err != nil {
+            return err
+        }
     }
 
     return nil
 }
 
+// interfaceName 把 ifindex 解析为网卡名并缓存，网卡已不存在时使用 ifindex
+func (m *MetricUpdater) interfaceName(ifindex uint32) string {
+    if name, ok := m.ifaceNames[ifindex]; ok {
+        return name
+    }
+    name := strconv.Itoa(int(ifindex))
+    if iface, err := net.InterfaceByIndex(int(ifindex)); err == nil {
+        name = iface.Name
+    }
+    m.ifaceNames[ifindex] = name
+    return name
+}
+
 // UpdateNetworkTraffic 更新网络吞吐指标
 func (m *MetricUpdater) UpdateCpuStatMetrics() error {
     if m == nil {
         return fmt.Errorf("MetricUpdater为nil")
     }
-    if m.cpuStatMap == nil {
+    if !m.cpuStatIter {
         return m.UpdateCpuStatMetricsByKernelMod()
     }
-    // return m.UpdateCpuStatMetricsByKernelMod()
+    // cpu_stat 迭代器在抓取时读取（BPFScrape），这里只需要更新内核模块路径
+    return nil
+}
 
-    var key uint32
-    var perCPUValues []cpu_stat
-    iter := m.cpuStatMap.Iterate()
-    for iter.Next(&key, &perCPUValues) {
-        if int(key) < len(perCPUValues) {
-            value := perCPUValues[key]
-            if (value.Online == 0) {
-                continue
+func (m *MetricUpdater) UpdateCpuStatMetricsByKernelMod() error {
+    // 首次使用时建立映射，之后每次更新只读共享内存
+    if m.kmodCpuStat == nil {
+        ring, err := OpenCpuStatRing(CpuStatDevicePath)
+        if err != nil {
+            return fmt.Errorf("fail to update CpuStat metric: %v", err)
+        }
+        m.kmodCpuStat = ring
+    }
+    return m.kmodCpuStat.UpdateMetrics()
+}
+
+func (m *MetricUpdater) UpdateTcpStatMetrics() error {
+    if m == nil {
+        return fmt.Errorf("MetricUpdater为nil")
+    }
+    if m.tcpMonitor.statsMap == nil {
+        return fmt.Errorf("TcpStatMap为nil")
+    }
+
+    fmt.Println("[UpdateTcpStatMetrics] update once...")
+    // hist 为每个 CPU 一份的累计计数，求和后直接作为常量直方图导出。
+    // 每个配置的端口一行，最后一行为其余端口
+    var perCPUHist []tcpPortHist
+    var total tcpPortHist
+    for row := 0; row <= len(m.tcpPorts); row++ {
+        port := "other"
+        index := uint32(tcpMaxPorts)
+        if row < len(m.tcpPorts) {
+            port = strconv.Itoa(int(m.tcpPorts[row]))
+            index = uint32(row)
+        }
+        if err := m.tcpMonitor.statsMap.Lookup(index, &perCPUHist); err != nil {
+            return fmt.Errorf("读取 hist 失败: %v", err)
+        }
+        total = tcpPortHist{}
+        for cpu := range perCPUHist {
+            h := &perCPUHist[cpu]
+            total.Count += h.Count
+            total.SumUs += h.SumUs
+            for slot := range h.Slots {
+                total.Slots[slot] += h.Slots[slot]
             }
-            fmt.Printf("key: %d, user %d, system %d\n", key, value.User, value.System)
-            cpuStatNumbers.WithLabelValues("User", strconv.Itoa(int(key)), "111").Set(float64(value.User))
-            cpuStatNumbers.WithLabelValues("System", strconv.Itoa(int(key)), "111").Set(float64(value.System))
-            cpuStatNumbers.WithLabelValues("Nice", strconv.Itoa(int(key)), "111").Set(float64(value.Nice))
-            cpuStatNumbers.WithLabelValues("Idle", strconv.Itoa(int(key)), "111").Set(float64(value.Idle))
-            cpuStatNumbers.WithLabelValues("Iowait", strconv.Itoa(int(key)),"111").Set(float64(value.Iowait))
-            cpuStatNumbers.WithLabelValues("Irq", strconv.Itoa(int(key)), "111").Set(float64(value.Irq))
-            cpuStatNumbers.WithLabelValues("Softirq", strconv.Itoa(int(key)), "111").Set(float64(value.Softirq))
-            cpuStatNumbers.WithLabelValues("Steal", strconv.Itoa(int(key)), "111").Set(float64(value.Steal))
-            cpuStatNumbers.WithLabelValues("Guest", strconv.Itoa(int(key)), "111").Set(float64(value.Guest))
-            cpuStatNumbers.WithLabelValues("Guest_nice", strconv.Itoa(int(key)), "111").Set(float64(value.Guest_nice))
         }
+        TcpStatMetric.Set(total.Count, total.SumUs, total.Slots[:], port, "111")
+    }
+
+    var perCPU []uint64
+    counters, ok := m.tcpMonitor.coll.Maps["tcp_stat_counters"]
+    if !ok {
+        return fmt.Errorf("找不到 tcp_stat_counters 映射")
+    }
+    for index, name := range TcpStatCounterNames {
+        if err := counters.Lookup(uint32(index), &perCPU); err != nil {
+            return fmt.Errorf("读取 tcp_stat_counters 失败: %v", err)
+        }
+        var total uint64
+        for _, v := range perCPU {
+            total += v
+        }
+        tcpHandshakeEvents.Set(total, name, "111")
     }
 
     return nil
 }
 
-func (m *MetricUpdater) UpdateCpuStatMetricsByKernelMod() error {
-	file, err := os.OpenFile("/dev/cpu_stat_monitor", os.O_RDONLY, 0)
-	if err != nil {
-		return fmt.Errorf("fail to update CpuStat metric, OpenFile failed: %v\n", err)
-	}
-	defer file.Close()
 
-	// 定义stat_count和stat_size
-	const statCount = 128
-	statSize := int(statCount * unsafe.Sizeof(cpu_stat{}))
+// UpdateTcpRetransMetrics 更新 TCP 重传与 srtt 指标
+func (m *MetricUpdater) UpdateTcpRetransMetrics() error {
+    if m == nil {
+        return fmt.Errorf("MetricUpdater为nil")
+    }
+    if m.tcpRetrans == nil {
+        return nil
+    }
+    return m.tcpRetrans.Update(TcpRetrans)
+}
 
-	// 内存映射
-	data, err := syscall.Mmap(int(file.Fd()), 0, statSize, syscall.PROT_READ, syscall.MAP_SHARED)
-	if err != nil {
-		return fmt.Errorf("Mmap failed: %v\n", err)
-	}
-	defer syscall.Munmap(data)
-
-	// 使用 binary.Read 安全地读取数据
-	reader := bytes.NewReader(data)
-	stats := make([]cpu_stat, statCount)
-
-	// --- 这是关键的修改 ---
-	// 不要一次性读取整个切片，而是循环逐个读取
-	// 这避免了 binary.Read 使用需要特殊对齐的 AVX 批量读取指令
-	for i := 0; i < statCount; i++ {
-		// 读取单个 cpu_stat 结构体到切片的对应位置
-		if err := binary.Read(reader, binary.LittleEndian, &stats[i]); err != nil {
-			return fmt.Errorf("failed to read mmap data for stat index %d: %v", i, err)
-		}
-	}
-	log.Printf("user %d, system %d", stats[0].User, stats[0].System)
+func (m *MetricUpdater) UpdateRunqlatMetrics() error {
+    if m == nil {
+        return fmt.Errorf("MetricUpdater为nil")
+    }
+    if m.runqlat == nil {
+        return nil
+    }
+    return m.runqlat.Update()
+}
+
+func (m *MetricUpdater) UpdateBlockIOMetrics() error {
+    if m == nil {
+        return fmt.Errorf("MetricUpdater为nil")
+    }
+    if m.blockIO == nil {
+        return nil
+    }
+    return m.blockIO.Update()
+}
+
+func (m *MetricUpdater) UpdateMemStallMetrics() error {
+    if m == nil {
+        return fmt.Errorf("MetricUpdater为nil")
+    }
+    if m.memStall == nil {
+        return nil
+    }
+    return m.memStall.Update()
+}
 
-	// 循环现在是安全的
-	for i := 0; i < len(stats); i++ {
-		stat := stats[i]
-        if (stat.Online == 0) {
+func parseTcpPorts(list string) ([]uint16, error) {
+    var ports []uint16
+    for _, field := range strings.Split(list, ",") {
+        field = strings.TrimSpace(field)
+        if field == "" {
             continue
         }
-        cpuStatNumbers.WithLabelValues("User", strconv.Itoa(i), "111").Set(float64(stat.User))
-		cpuStatNumbers.WithLabelValues("System", strconv.Itoa(i), "111").Set(float64(stat.System))
-        cpuStatNumbers.WithLabelValues("Nice", strconv.Itoa(i), "111").Set(float64(stat.Nice))
-        cpuStatNumbers.WithLabelValues("Idle", strconv.Itoa(i), "111").Set(float64(stat.Idle))
-        cpuStatNumbers.WithLabelValues("Iowait", strconv.Itoa(i),"111").Set(float64(stat.Iowait))
-        cpuStatNumbers.WithLabelValues("Irq", strconv.Itoa(i), "111").Set(float64(stat.Irq))
-        cpuStatNumbers.WithLabelValues("Softirq", strconv.Itoa(i), "111").Set(float64(stat.Softirq))
-        cpuStatNumbers.WithLabelValues("Steal", strconv.Itoa(i), "111").Set(float64(stat.Steal))
-        cpuStatNumbers.WithLabelValues("Guest", strconv.Itoa(i), "111").Set(float64(stat.Guest))
-        cpuStatNumbers.WithLabelValues("Guest_nice", strconv.Itoa(i), "111").Set(float64(stat.Guest_nice))
-	}
+        port, err := strconv.ParseUint(field, 10, 16)
+        if err != nil {
+            return nil, fmt.Errorf("invalid port %q", field)
+        }
+        ports = append(ports, uint16(port))
+    }
+    return ports, nil
+}
+
+// SetTcpConnDelayPorts 设置单独统计握手延迟的本端端口，最多 tcpMaxPorts 个。
+// 端口按顺序占用 hist 的行，重新配置时清零各行并移除旧的指标；
+// 重复的端口只保留第一次出现的位置，否则后一行会覆盖 tcp_ports 中的行号，前一行成为永远为0的序列
+func (m *MetricUpdater) SetTcpConnDelayPorts(ports []uint16) error {
+    seen := make(map[uint16]bool, len(ports))
+    unique := make([]uint16, 0, len(ports))
+    for _, port := range ports {
+        if seen[port] {
+            log.Printf("握手延迟端口 %d 重复，忽略", port)
+            continue
+        }
+        seen[port] = true
+        unique = append(unique, port)
+    }
+    ports = unique
+
+    if len(ports) > tcpMaxPorts {
+        return fmt.Errorf("最多配置 %d 个端口，实际 %d 个", tcpMaxPorts, len(ports))
+    }
+    portsMap, ok := m.tcpMonitor.coll.Maps["tcp_ports"]
+    if !ok {
+        return fmt.Errorf("找不到 tcp_ports 映射")
+    }
+
+    for _, port := range m.tcpPorts {
+        if err := portsMap.Delete(port); err != nil {
+            return fmt.Errorf("删除端口 %d 失败: %v", port, err)
+        }
+    }
+    m.tcpPorts = nil
+    TcpStatMetric.Reset()
 
+    // 先清零行再发布端口，避免新端口继承上一个占用该行的端口的计数
+    var perCPU []tcpPortHist
+    if err := m.tcpMonitor.statsMap.Lookup(uint32(0), &perCPU); err != nil {
+        return fmt.Errorf("读取 hist 失败: %v", err)
+    }
+    zero := make([]tcpPortHist, len(perCPU))
+    for index, port := range ports {
+        if err := m.tcpMonitor.statsMap.Update(uint32(index), zero, ebpf.UpdateAny); err != nil {
+            return fmt.Errorf("清零 hist 失败: %v", err)
+        }
+        if err := portsMap.Update(port, uint32(index), ebpf.UpdateAny); err != nil {
+            return fmt.Errorf("添加端口 %d 失败: %v", port, err)
+        }
+        m.tcpPorts = append(m.tcpPorts, port)
+    }
     return nil
 }
 
-func (m *MetricUpdater) UpdateTcpStatMetrics() error {
+func plainSnapshotPath() string {
+    if path := os.Getenv("PLAIN_SNAPSHOT_PATH"); path != "" {
+        return path
+    }
+    return DefaultPlainSnapshotPath
+}
+
+// UpdatePlainMetrics 从 plain_monitord 的共享内存快照更新内存、负载和磁盘指标
+func (m *MetricUpdater) UpdatePlainMetrics() error {
     if m == nil {
         return fmt.Errorf("MetricUpdater为nil")
     }
-    if m.tcpMonitor.statsMap == nil {
-        return fmt.Errorf("TcpStatMap为nil")
+    // 守护进程重建了快照（重启或修改了磁盘容量）时重新映射
+    if m.plainSnapshot != nil && !m.plainSnapshot.Valid() {
+        m.plainSnapshot.Close()
+        m.plainSnapshot = nil
     }
+    if m.plainSnapshot == nil {
+        snapshot, err := OpenPlainSnapshot(plainSnapshotPath())
+        if err != nil {
+            return err
+        }
+        m.plainSnapshot = snapshot
+    }
+    snapshot := m.plainSnapshot
 
-    fmt.Println("[UpdateTcpStatMetrics] update once...")
-    var key uint32
-    var value uint64
-    iter := m.tcpMonitor.statsMap.Iterate()
-    for iter.Next(&key, &value) {
-        fmt.Printf("current thres: %d, val: %d\n", key, value)
-        upperBoundUs := math.Pow(2, float64(key+1)) - 1
-		histogram, err := TcpStatMetric.GetMetricWithLabelValues("111")
-		if err != nil {
-			log.Printf("Error getting metric with label: %v", err)
-			continue
-		}
-		for i := uint64(0); i < value; i++ {
-			histogram.Observe(upperBoundUs)
-		}
+    var mem MemInfo
+    if _, err := snapshot.ReadMemInfo(&mem); err != nil {
+        return fmt.Errorf("读取内存快照失败: %v", err)
+    }
+    for i, value := range mem {
+        plainMemInfo.WithLabelValues(MemInfoNames[i], "111").Set(float64(value))
     }
-    
-    return nil
-}
 
+    var load LoadAvg
+    if _, err := snapshot.ReadLoadAvg(&load); err != nil {
+        return fmt.Errorf("读取负载快照失败: %v", err)
+    }
+    plainCpuLoad.WithLabelValues("load_1min", "111").Set(load.Load1min)
+    plainCpuLoad.WithLabelValues("load_5min", "111").Set(load.Load5min)
+    plainCpuLoad.WithLabelValues("load_15min", "111").Set(load.Load15min)
+    plainCpuLoad.WithLabelValues("cpu_count", "111").Set(float64(load.CpuCount))
+    plainCpuLoad.WithLabelValues("load_1min_per_core", "111").Set(load.Load1minPerCore)
+    plainCpuLoad.WithLabelValues("load_5min_per_core", "111").Set(load.Load5minPerCore)
+    plainCpuLoad.WithLabelValues("load_15min_per_core", "111").Set(load.Load15minPerCore)
+    plainCpuLoad.WithLabelValues("load_1s", "111").Set(load.Load1s)
+    plainCpuLoad.WithLabelValues("load_10s", "111").Set(load.Load10s)
+    plainCpuLoad.WithLabelValues("load_60s", "111").Set(load.Load60s)
 
+    disks, dropped, err := snapshot.ReadDisks()
+    if err != nil {
+        return fmt.Errorf("读取磁盘快照失败: %v", err)
+    }
+    if dropped > 0 {
+        log.Printf("plain_monitord 快照容量不足，%d 个磁盘未发布", dropped)
+    }
+    // 原地更新在用设备的序列，只删除已拔出的设备；先 Reset 再重建会让期间的抓取看不到任何磁盘
+    current := make(map[string]bool, len(disks))
+    for i := range disks {
+        d := &disks[i]
+        name := diskName(d)
+        current[name] = true
+        plainDiskStat.WithLabelValues("read_throughput_mb", name, "111").Set(d.ReadThroughputMb)
+        plainDiskStat.WithLabelValues("write_throughput_mb", name, "111").Set(d.WriteThroughputMb)
+        plainDiskStat.WithLabelValues("read_iops", name, "111").Set(d.ReadIops)
+        plainDiskStat.WithLabelValues("write_iops", name, "111").Set(d.WriteIops)
+        plainDiskStat.WithLabelValues("avg_read_latency_ms", name, "111").Set(d.AvgReadLatencyMs)
+        plainDiskStat.WithLabelValues("avg_write_latency_ms", name, "111").Set(d.AvgWriteLatencyMs)
+        plainDiskStat.WithLabelValues("utilization", name, "111").Set(d.Utilization)
+        plainDiskStat.WithLabelValues("ios_in_progress", name, "111").Set(float64(d.IosInProgress))
+    }
+    for name := range m.plainDisks {
+        if current[name] {
+            continue
+        }
+        for _, stat := range PlainDiskStatNames {
+            plainDiskStat.DeleteLabelValues(stat, name, "111")
+        }
+    }
+    m.plainDisks = current
+
+    nodes, err := snapshot.ReadNuma()
+    if err != nil {
+        return fmt.Errorf("读取 NUMA 快照失败: %v", err)
+    }
+    for i := range nodes {
+        n := &nodes[i]
+        numaNode := strconv.Itoa(int(n.Node))
+        if n.Valid == 0 {
+            // 节点下线
+            for _, stat := range NodeStatNames {
+                plainNumaStat.DeleteLabelValues(numaNode, stat, "111")
+            }
+            continue
+        }
+        for j, value := range n.Stats {
+            plainNumaStat.WithLabelValues(numaNode, NodeStatNames[j], "111").Set(float64(value))
+        }
+    }
+
+    triggers, err := snapshot.ReadPsi()
+    if err != nil {
+        return fmt.Errorf("读取 PSI 快照失败: %v", err)
+    }
+    // 有效触发器的序列原地更新；cgroup 被删除或触发器失效后只删除它自己的序列
+    active := make(map[plainPsiLabels]bool, len(triggers))
+    for i := range triggers {
+        t := &triggers[i]
+        if t.Active == 0 {
+            continue
+        }
+        l := plainPsiLabels{cgroup: cString(t.Cgroup[:]), resource: "unknown", kind: "some"}
+        if int(t.Resource) < len(PsiResourceNames) {
+            l.resource = PsiResourceNames[t.Resource]
+        }
+        if t.Full != 0 {
+            l.kind = "full"
+        }
+        active[l] = true
+        plainPsiEvents.Set(t.Events, l.cgroup, l.resource, l.kind, "111")
+        plainPsiLastEvent.WithLabelValues(l.cgroup, l.resource, l.kind, "111").Set(float64(t.LastEventNs) / 1e9)
+        plainPsiStall.WithLabelValues(l.cgroup, l.resource, l.kind, "avg10", "111").Set(t.Avg10)
+        plainPsiStall.WithLabelValues(l.cgroup, l.resource, l.kind, "avg60", "111").Set(t.Avg60)
+        plainPsiStall.WithLabelValues(l.cgroup, l.resource, l.kind, "avg300", "111").Set(t.Avg300)
+        plainPsiStall.WithLabelValues(l.cgroup, l.resource, l.kind, "total", "111").Set(float64(t.TotalUs))
+    }
+    for l := range m.plainPsi {
+        if active[l] {
+            continue
+        }
+        plainPsiEvents.Delete(l.cgroup, l.resource, l.kind, "111")
+        plainPsiLastEvent.DeleteLabelValues(l.cgroup, l.resource, l.kind, "111")
+        for _, stat := range []string{"avg10", "avg60", "avg300", "total"} {
+            plainPsiStall.DeleteLabelValues(l.cgroup, l.resource, l.kind, stat, "111")
+        }
+    }
+    m.plainPsi = active
+
+    return nil
+}
 
 func getSoftirqTypeName(i uint32) string {
     if i >= 0 || i < uint32(len(SoftirqNames)) {
@@ -522,6 +1105,20 @@ func getTrafficName(i uint32) string {
     return "unknown_" + strconv.Itoa(int(i))
 }
 
+func getTrafficL3Name(proto uint8) string {
+    if name, ok := TrafficL3Names[proto]; ok {
+        return name
+    }
+    return "unknown_" + strconv.Itoa(int(proto))
+}
+
+func getTrafficL4Name(proto uint8) string {
+    if name, ok := TrafficL4Names[proto]; ok {
+        return name
+    }
+    return "unknown_" + strconv.Itoa(int(proto))
+}
+
 func getCpuStatsName(i uint32) string {
     if i >= 0 || i < uint32(len(CpuStatsNames)) {
         return CpuStatsNames[i]
@@ -0,0 +1,286 @@
+package exporter
+
+import (
+    "bytes"
+    "fmt"
+    "os"
+    "runtime"
+    "sync/atomic"
+    "syscall"
+    "unsafe"
+)
+
+// plain_monitord 发布的共享内存快照（见 plain_monitor/snapshot_shm.h）
+// 映射只建立一次，之后每次读取只是对共享内存的原子读，不经过系统调用和 cgo
+const (
+    DefaultPlainSnapshotPath = "/dev/shm/plain_monitor_snapshot"
+
+    plainSnapshotMagic      = 0x4e534d50
+    plainSnapshotVersion    = 4
+    plainSeqlockSize        = 16 // seq + update_time_ns
+    plainDiskCountSize      = 8  // count + dropped
+    plainPsiCountSize       = 8  // count + capacity
+    plainNumaCountSize      = 8  // count + capacity
+    plainSnapshotMaxRetries = 1000
+    plainSpinBeforeYield    = 64
+)
+
+// 对应 SnapshotHeader
+type plainSnapshotHeader struct {
+    Magic         uint32
+    Version       uint32
+    RegionSize    uint32
+    DiskCapacity  uint32
+    MemOffset     uint32
+    MemSize       uint32
+    LoadOffset    uint32
+    LoadSize      uint32
+    DiskOffset    uint32
+    DiskEntrySize uint32
+    PsiOffset     uint32
+    PsiEntrySize  uint32
+    NumaOffset    uint32
+    NumaEntrySize uint32
+    WriterPid     uint64
+}
+
+type PlainSnapshot struct {
+    path   string
+    ino    uint64 // 映射时的 inode，守护进程重建快照后路径会指向新的 inode
+    data   []byte
+    header *plainSnapshotHeader
+    disks  []DiskStats // 复用的读缓冲区，容量为 disk_capacity
+    psi    []PsiTrigger // 复用的读缓冲区，容量为 psi 区段的 capacity
+    nodes  []NodeStats  // 复用的读缓冲区，容量为 numa 区段的 capacity
+}
+
+// OpenPlainSnapshot 只读映射快照并校验布局与 Go 侧结构体一致
+func OpenPlainSnapshot(path string) (*PlainSnapshot, error) {
+    file, err := os.OpenFile(path, os.O_RDONLY, 0)
+    if err != nil {
+        return nil, fmt.Errorf("打开快照失败: %v", err)
+    }
+    defer file.Close()
+
+    info, err := file.Stat()
+    if err != nil {
+        return nil, fmt.Errorf("获取快照大小失败: %v", err)
+    }
+    size := int(info.Size())
+    if size < int(unsafe.Sizeof(plainSnapshotHeader{})) {
+        return nil, fmt.Errorf("快照大小异常: %d", size)
+    }
+
+    data, err := syscall.Mmap(int(file.Fd()), 0, size, syscall.PROT_READ, syscall.MAP_SHARED)
+    if err != nil {
+        return nil, fmt.Errorf("Mmap failed: %v", err)
+    }
+
+    s := &PlainSnapshot{
+        path:   path,
+        ino:    info.Sys().(*syscall.Stat_t).Ino,
+        data:   data,
+        header: (*plainSnapshotHeader)(unsafe.Pointer(&data[0])),
+    }
+    if err := s.validate(); err != nil {
+        syscall.Munmap(data)
+        return nil, err
+    }
+    s.disks = make([]DiskStats, s.header.DiskCapacity)
+    s.psi = make([]PsiTrigger, s.sectionCapacity(s.header.PsiOffset))
+    s.nodes = make([]NodeStats, s.sectionCapacity(s.header.NumaOffset))
+    return s, nil
+}
+
+func (s *PlainSnapshot) validate() error {
+    h := s.header
+    if atomic.LoadUint32(&h.Magic) != plainSnapshotMagic {
+        return fmt.Errorf("快照尚未初始化或 magic 不匹配")
+    }
+    if h.Version != plainSnapshotVersion {
+        return fmt.Errorf("快照版本不匹配: %d", h.Version)
+    }
+    if int(h.RegionSize) != len(s.data) {
+        return fmt.Errorf("快照大小变化: %d -> %d", len(s.data), h.RegionSize)
+    }
+    if uintptr(h.MemSize) != unsafe.Sizeof(MemInfo{}) ||
+        uintptr(h.LoadSize) != unsafe.Sizeof(LoadAvg{}) ||
+        uintptr(h.DiskEntrySize) != unsafe.Sizeof(DiskStats{}) ||
+        uintptr(h.PsiEntrySize) != unsafe.Sizeof(PsiTrigger{}) ||
+        uintptr(h.NumaEntrySize) != unsafe.Sizeof(NodeStats{}) {
+        return fmt.Errorf("快照结构体大小与 Go 定义不一致: mem %d load %d disk %d psi %d numa %d",
+            h.MemSize, h.LoadSize, h.DiskEntrySize, h.PsiEntrySize, h.NumaEntrySize)
+    }
+    diskEnd := uint64(h.DiskOffset) + plainSeqlockSize + plainDiskCountSize +
+        uint64(h.DiskCapacity)*uint64(h.DiskEntrySize)
+    psiEnd := s.arrayEnd(h.PsiOffset, plainPsiCountSize, h.PsiEntrySize)
+    numaEnd := s.arrayEnd(h.NumaOffset, plainNumaCountSize, h.NumaEntrySize)
+    if uint64(h.MemOffset)+plainSeqlockSize+uint64(h.MemSize) > uint64(len(s.data)) ||
+        uint64(h.LoadOffset)+plainSeqlockSize+uint64(h.LoadSize) > uint64(len(s.data)) ||
+        diskEnd > uint64(len(s.data)) || psiEnd > uint64(len(s.data)) || numaEnd > uint64(len(s.data)) {
+        return fmt.Errorf("快照区段越界")
+    }
+    return nil
+}
+
+// sectionCapacity 读取 psi/numa 区段计数中的 capacity（格式化时写入，之后不变）
+func (s *PlainSnapshot) sectionCapacity(offset uint32) uint64 {
+    return atomic.LoadUint64(s.word(uintptr(offset)+plainSeqlockSize)) >> 32
+}
+
+// arrayEnd 返回以 count + capacity 开头的定长数组区段的结束偏移，计数本身越界时返回越界值
+func (s *PlainSnapshot) arrayEnd(offset uint32, countSize uint64, entrySize uint32) uint64 {
+    end := uint64(offset) + plainSeqlockSize + countSize
+    if end > uint64(len(s.data)) {
+        return end
+    }
+    return end + s.sectionCapacity(offset)*uint64(entrySize)
+}
+
+// Valid 守护进程重启时在临时名字下建好新快照再 rename 到同一路径，旧映射仍指向旧 inode（数据不再更新），
+// 因此除了校验布局还要确认路径对应的仍是已映射的 inode；返回 false 时调用方重新映射
+func (s *PlainSnapshot) Valid() bool {
+    if s.validate() != nil {
+        return false
+    }
+    info, err := os.Stat(s.path)
+    if err != nil {
+        return true  // 守护进程已停止且快照被删除，继续提供最后一次的数据
+    }
+    return info.Sys().(*syscall.Stat_t).Ino == s.ino
+}
+
+func (s *PlainSnapshot) Close() {
+    if s.data != nil {
+        syscall.Munmap(s.data)
+        s.data = nil
+        s.header = nil
+    }
+}
+
+func (s *PlainSnapshot) word(offset uintptr) *uint64 {
+    return (*uint64)(unsafe.Pointer(&s.data[offset]))
+}
+
+// 逐字原子读取共享内存，保证读端不会被编译器合并或重排到 seq 的两次读取之外
+func (s *PlainSnapshot) loadWords(dst []uint64, offset uintptr) {
+    for i := range dst {
+        dst[i] = atomic.LoadUint64(s.word(offset + uintptr(i)*8))
+    }
+}
+
+// readSection 在 seqlock 保护下执行 copyFn，返回读到的一致快照的发布时间
+func (s *PlainSnapshot) readSection(offset uint32, copyFn func(data uintptr)) (uint64, error) {
+    seq := s.word(uintptr(offset))
+    updateTime := s.word(uintptr(offset) + 8)
+    data := uintptr(offset) + plainSeqlockSize
+
+    for retries := 0; retries <= plainSnapshotMaxRetries; retries++ {
+        // 写端在临界区内被抢占时让出处理器
+        if retries > 0 && retries%plainSpinBeforeYield == 0 {
+            runtime.Gosched()
+        }
+        begin := atomic.LoadUint64(seq)
+        if begin&1 != 0 {
+            continue
+        }
+        copyFn(data)
+        ts := atomic.LoadUint64(updateTime)
+        if atomic.LoadUint64(seq) == begin {
+            return ts, nil
+        }
+    }
+    return 0, fmt.Errorf("快照在 %d 次重试后仍不一致", plainSnapshotMaxRetries)
+}
+
+func (s *PlainSnapshot) ReadMemInfo(info *MemInfo) (uint64, error) {
+    return s.readSection(s.header.MemOffset, func(data uintptr) {
+        s.loadWords(info[:], data)
+    })
+}
+
+func (s *PlainSnapshot) ReadLoadAvg(load *LoadAvg) (uint64, error) {
+    words := unsafe.Slice((*uint64)(unsafe.Pointer(load)), unsafe.Sizeof(*load)/8)
+    return s.readSection(s.header.LoadOffset, func(data uintptr) {
+        s.loadWords(words, data)
+    })
+}
+
+// ReadDisks 返回的切片指向内部缓冲区，在下一次 ReadDisks 之前有效
+func (s *PlainSnapshot) ReadDisks() ([]DiskStats, uint32, error) {
+    var count, dropped uint32
+    entrySize := unsafe.Sizeof(DiskStats{})
+
+    _, err := s.readSection(s.header.DiskOffset, func(data uintptr) {
+        counts := atomic.LoadUint64(s.word(data))
+        count = uint32(counts)
+        dropped = uint32(counts >> 32)
+        if count > uint32(len(s.disks)) {
+            count = uint32(len(s.disks))  // 读到写了一半的计数，seq 校验会让本次读取重试
+        }
+        entries := data + plainDiskCountSize
+        for i := uint32(0); i < count; i++ {
+            words := unsafe.Slice((*uint64)(unsafe.Pointer(&s.disks[i])), entrySize/8)
+            s.loadWords(words, entries+uintptr(i)*entrySize)
+        }
+    })
+    if err != nil {
+        return nil, 0, err
+    }
+    return s.disks[:count], dropped, nil
+}
+
+// ReadPsi 返回的切片指向内部缓冲区，在下一次 ReadPsi 之前有效
+func (s *PlainSnapshot) ReadPsi() ([]PsiTrigger, error) {
+    var count uint32
+    entrySize := unsafe.Sizeof(PsiTrigger{})
+
+    _, err := s.readSection(s.header.PsiOffset, func(data uintptr) {
+        count = uint32(atomic.LoadUint64(s.word(data)))
+        if count > uint32(len(s.psi)) {
+            count = uint32(len(s.psi))
+        }
+        entries := data + plainPsiCountSize
+        for i := uint32(0); i < count; i++ {
+            words := unsafe.Slice((*uint64)(unsafe.Pointer(&s.psi[i])), entrySize/8)
+            s.loadWords(words, entries+uintptr(i)*entrySize)
+        }
+    })
+    if err != nil {
+        return nil, err
+    }
+    return s.psi[:count], nil
+}
+
+// ReadNuma 返回的切片指向内部缓冲区，在下一次 ReadNuma 之前有效
+func (s *PlainSnapshot) ReadNuma() ([]NodeStats, error) {
+    var count uint32
+    entrySize := unsafe.Sizeof(NodeStats{})
+
+    _, err := s.readSection(s.header.NumaOffset, func(data uintptr) {
+        count = uint32(atomic.LoadUint64(s.word(data)))
+        if count > uint32(len(s.nodes)) {
+            count = uint32(len(s.nodes))
+        }
+        entries := data + plainNumaCountSize
+        for i := uint32(0); i < count; i++ {
+            words := unsafe.Slice((*uint64)(unsafe.Pointer(&s.nodes[i])), entrySize/8)
+            s.loadWords(words, entries+uintptr(i)*entrySize)
+        }
+    })
+    if err != nil {
+        return nil, err
+    }
+    return s.nodes[:count], nil
+}
+
+func diskName(d *DiskStats) string {
+    return cString(d.Name[:])
+}
+
+func cString(b []byte) string {
+    if n := bytes.IndexByte(b, 0); n >= 0 {
+        return string(b[:n])
+    }
+    return string(b)
+}
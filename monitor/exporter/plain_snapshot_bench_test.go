@@ -0,0 +1,193 @@
+package exporter
+
+import (
+    "os"
+    "path/filepath"
+    "sync"
+    "sync/atomic"
+    "syscall"
+    "testing"
+    "unsafe"
+)
+
+// 基准测试：PlainSnapshot 读端延迟（无写端 / 写端持续发布），并校验读到的快照没有撕裂
+// 快照按 snapshot_shm_format 的布局在临时文件中构造，不依赖正在运行的 plain_monitord：
+//   go test ./exporter -run '^$' -bench PlainSnapshot -benchmem
+
+const (
+    benchSnapshotAlign = 64
+    benchSnapshotDisks = 64
+    benchPsiCapacity   = 64 // PSI_MAX_TRIGGERS
+    benchNumaCapacity  = 64 // NUMA_MAX_NODES
+)
+
+func benchAlign(v uintptr) uintptr {
+    return (v + benchSnapshotAlign - 1) &^ (benchSnapshotAlign - 1)
+}
+
+// benchSnapshot 同一个快照文件的两个映射：读端是 OpenPlainSnapshot 的只读映射，写端是可写映射
+type benchSnapshot struct {
+    reader *PlainSnapshot
+    writer []byte
+}
+
+func (w *benchSnapshot) word(offset uintptr) *uint64 {
+    return (*uint64)(unsafe.Pointer(&w.writer[offset]))
+}
+
+// publishMemInfo 按 seqlock 写端的顺序发布所有字段都等于 value 的 MemInfo
+func (w *benchSnapshot) publishMemInfo(value uint64) {
+    offset := uintptr(w.reader.header.MemOffset)
+    seq := w.word(offset)
+    begin := atomic.LoadUint64(seq)
+
+    atomic.StoreUint64(seq, begin+1)
+    for i := 0; i < MemInfoFields; i++ {
+        atomic.StoreUint64(w.word(offset+plainSeqlockSize+uintptr(i)*8), value)
+    }
+    atomic.StoreUint64(w.word(offset+8), value)
+    atomic.StoreUint64(seq, begin+2)
+}
+
+func newBenchSnapshot(b *testing.B, disks uint32) *benchSnapshot {
+    memSize := unsafe.Sizeof(MemInfo{})
+    loadSize := unsafe.Sizeof(LoadAvg{})
+    diskSize := unsafe.Sizeof(DiskStats{})
+    psiSize := unsafe.Sizeof(PsiTrigger{})
+    numaSize := unsafe.Sizeof(NodeStats{})
+
+    header := plainSnapshotHeader{
+        Magic:         plainSnapshotMagic,
+        Version:       plainSnapshotVersion,
+        DiskCapacity:  benchSnapshotDisks,
+        MemSize:       uint32(memSize),
+        LoadSize:      uint32(loadSize),
+        DiskEntrySize: uint32(diskSize),
+        PsiEntrySize:  uint32(psiSize),
+        NumaEntrySize: uint32(numaSize),
+        WriterPid:     uint64(os.Getpid()),
+    }
+    offset := benchAlign(unsafe.Sizeof(header))
+    header.MemOffset = uint32(offset)
+    offset += benchAlign(plainSeqlockSize + memSize)
+    header.LoadOffset = uint32(offset)
+    offset += benchAlign(plainSeqlockSize + loadSize)
+    header.DiskOffset = uint32(offset)
+    offset += benchAlign(plainSeqlockSize + plainDiskCountSize + benchSnapshotDisks*diskSize)
+    header.PsiOffset = uint32(offset)
+    offset += benchAlign(plainSeqlockSize + plainPsiCountSize + benchPsiCapacity*psiSize)
+    header.NumaOffset = uint32(offset)
+    offset += benchAlign(plainSeqlockSize + plainNumaCountSize + benchNumaCapacity*numaSize)
+    header.RegionSize = uint32(offset)
+
+    path := filepath.Join(b.TempDir(), "plain_monitor_snapshot")
+    file, err := os.OpenFile(path, os.O_RDWR|os.O_CREATE, 0644)
+    if err != nil {
+        b.Fatal(err)
+    }
+    defer file.Close()
+    if err := file.Truncate(int64(offset)); err != nil {
+        b.Fatal(err)
+    }
+    data, err := syscall.Mmap(int(file.Fd()), 0, int(offset), syscall.PROT_READ|syscall.PROT_WRITE, syscall.MAP_SHARED)
+    if err != nil {
+        b.Fatal(err)
+    }
+    b.Cleanup(func() { syscall.Munmap(data) })
+
+    *(*plainSnapshotHeader)(unsafe.Pointer(&data[0])) = header
+    w := &benchSnapshot{writer: data}
+    *w.word(uintptr(header.DiskOffset) + plainSeqlockSize) = uint64(disks)
+    *w.word(uintptr(header.PsiOffset) + plainSeqlockSize) = benchPsiCapacity << 32
+    *w.word(uintptr(header.NumaOffset) + plainSeqlockSize) = benchNumaCapacity << 32
+    for i := uint32(0); i < disks; i++ {
+        disk := (*DiskStats)(unsafe.Pointer(&data[uintptr(header.DiskOffset)+plainSeqlockSize+
+            plainDiskCountSize+uintptr(i)*diskSize]))
+        copy(disk.Name[:], "nvme0n1")
+        disk.Minor = i
+    }
+
+    w.reader, err = OpenPlainSnapshot(path)
+    if err != nil {
+        b.Fatal(err)
+    }
+    b.Cleanup(w.reader.Close)
+    w.publishMemInfo(1)
+    return w
+}
+
+func benchTorn(info *MemInfo) bool {
+    for i := 1; i < MemInfoFields; i++ {
+        if info[i] != info[0] {
+            return true
+        }
+    }
+    return false
+}
+
+// 写端连续发布时读端可能在重试上限内都没有读到一致的快照，与 snapshot_shm_bench.c 一样只计数不中止
+func benchReadMemInfo(b *testing.B, w *benchSnapshot) {
+    var info MemInfo
+    torn, failed := 0, 0
+
+    b.ReportAllocs()
+    b.ResetTimer()
+    for i := 0; i < b.N; i++ {
+        if _, err := w.reader.ReadMemInfo(&info); err != nil {
+            failed++
+            continue
+        }
+        if benchTorn(&info) {
+            torn++
+        }
+    }
+    b.StopTimer()
+    b.ReportMetric(float64(failed)/float64(b.N), "failed/read")
+    if torn > 0 {
+        b.Fatalf("读到 %d 次撕裂的快照", torn)
+    }
+}
+
+func BenchmarkPlainSnapshotReadMemInfo(b *testing.B) {
+    benchReadMemInfo(b, newBenchSnapshot(b, 0))
+}
+
+// 写端在另一个 goroutine 中不停发布（远比守护进程的采集周期密集），是读端重试的最坏情况
+func BenchmarkPlainSnapshotReadMemInfoContended(b *testing.B) {
+    w := newBenchSnapshot(b, 0)
+    var stop atomic.Bool
+    var writes uint64
+    var wg sync.WaitGroup
+
+    wg.Add(1)
+    go func() {
+        defer wg.Done()
+        for !stop.Load() {
+            writes++
+            w.publishMemInfo(writes)
+        }
+    }()
+    // b.Fatal 时同样要先停下写端，之后才能解除映射
+    defer wg.Wait()
+    defer stop.Store(true)
+    benchReadMemInfo(b, w)
+    stop.Store(true)
+    wg.Wait()
+    b.ReportMetric(float64(writes)/float64(b.N), "writes/read")
+}
+
+func BenchmarkPlainSnapshotReadDisks(b *testing.B) {
+    w := newBenchSnapshot(b, benchSnapshotDisks)
+
+    b.ReportAllocs()
+    b.ResetTimer()
+    for i := 0; i < b.N; i++ {
+        disks, _, err := w.reader.ReadDisks()
+        if err != nil {
+            b.Fatal(err)
+        }
+        if len(disks) != benchSnapshotDisks {
+            b.Fatalf("设备数 %d", len(disks))
+        }
+    }
+}
@@ -0,0 +1,151 @@
+package exporter
+
+import (
+    "fmt"
+    "strconv"
+
+    "github.com/cilium/ebpf"
+    "github.com/cilium/ebpf/link"
+)
+
+// RunqlatMonitor 读取 runqlat_monitor 的直方图：每个 CPU 一份，按 cgroup 统计打开时另有每个 cgroup 一份
+type RunqlatMonitor struct {
+    monitor     *Monitor
+    histMap     *ebpf.Map
+    cgroupMap   *ebpf.Map // 未打开按 cgroup 统计时为 nil
+    countersMap *ebpf.Map
+
+    cpuLabels []string
+    cgroups   *cgroupPaths
+}
+
+// attachRunqlatMonitoring 加载 runqlat_monitor.bpf.o 并挂载到 sched_wakeup、sched_wakeup_new 与 sched_switch
+func attachRunqlatMonitoring(codePath string, perCgroup bool) (*RunqlatMonitor, error) {
+    spec, err := ebpf.LoadCollectionSpec(codePath + ".output/runqlat_monitor.bpf.o")
+    if err != nil {
+        return nil, fmt.Errorf("加载eBPF集合规范失败: %v", err)
+    }
+    if perCgroup {
+        if err := spec.RewriteConstants(map[string]interface{}{"per_cgroup": uint32(1)}); err != nil {
+            return nil, fmt.Errorf("设置 per_cgroup 失败: %v", err)
+        }
+    }
+    collection, err := ebpf.NewCollection(spec)
+    if err != nil {
+        return nil, fmt.Errorf("创建eBPF集合失败: %v", err)
+    }
+    monitor := &Monitor{
+        coll: collection,
+    }
+    cleanup := func() {
+        for _, l := range monitor.links {
+            l.Close()
+        }
+        collection.Close()
+    }
+
+    // tp_btf 程序的挂载点由程序的 BTF 决定
+    for _, name := range []string{"handle_sched_wakeup", "handle_sched_wakeup_new", "handle_sched_switch"} {
+        prog, ok := collection.Programs[name]
+        if !ok {
+            cleanup()
+            return nil, fmt.Errorf("找不到 %s 程序", name)
+        }
+        l, err := link.AttachTracing(link.TracingOptions{Program: prog})
+        if err != nil {
+            cleanup()
+            return nil, fmt.Errorf("附加 %s 失败: %v", name, err)
+        }
+        monitor.links = append(monitor.links, l)
+    }
+
+    r := &RunqlatMonitor{
+        monitor:     monitor,
+        histMap:     collection.Maps["runq_hist"],
+        countersMap: collection.Maps["runq_counters"],
+        // 目录树中已经没有的 cgroup 删除对应的指标，map 中的项在 updateCgroups 里删除
+        cgroups: newCgroupPaths(func(path string) {
+            CgroupRunqLatency.Delete(path, "111")
+        }),
+    }
+    if perCgroup {
+        r.cgroupMap = collection.Maps["runq_cgroup_hist"]
+    }
+    if r.histMap == nil || r.countersMap == nil || (perCgroup && r.cgroupMap == nil) {
+        cleanup()
+        return nil, fmt.Errorf("找不到 runqlat_monitor 的映射")
+    }
+    monitor.statsMap = r.histMap
+    return r, nil
+}
+
+// Update 把每个 CPU 与每个 cgroup 的累计直方图交给 RunqLatency / CgroupRunqLatency
+func (r *RunqlatMonitor) Update() error {
+    var perCPU []runqHist
+    var index uint32
+    if err := r.histMap.Lookup(index, &perCPU); err != nil {
+        return fmt.Errorf("读取 runq_hist 失败: %v", err)
+    }
+    for len(r.cpuLabels) < len(perCPU) {
+        r.cpuLabels = append(r.cpuLabels, strconv.Itoa(len(r.cpuLabels)))
+    }
+    for cpu := range perCPU {
+        h := &perCPU[cpu]
+        if h.Count > 0 {
+            RunqLatency.Set(h.Count, h.SumNs, h.Slots[:], r.cpuLabels[cpu], "111")
+        }
+    }
+
+    var counters []uint64
+    for i, name := range RunqCounterNames {
+        if err := r.countersMap.Lookup(uint32(i), &counters); err != nil {
+            return fmt.Errorf("读取 runq_counters 失败: %v", err)
+        }
+        var total uint64
+        for _, v := range counters {
+            total += v
+        }
+        runqEvents.Set(total, name, "111")
+    }
+
+    if r.cgroupMap != nil {
+        return r.updateCgroups()
+    }
+    return nil
+}
+
+func (r *RunqlatMonitor) updateCgroups() error {
+    var id uint64
+    var perCPU []runqHist
+    var total runqHist
+    var gone []uint64
+
+    r.cgroups.begin()
+    iter := r.cgroupMap.Iterate()
+    for iter.Next(&id, &perCPU) {
+        path, ok := r.cgroups.lookup(id)
+        if !ok {
+            gone = append(gone, id)
+            continue
+        }
+        total = runqHist{}
+        for cpu := range perCPU {
+            h := &perCPU[cpu]
+            total.Count += h.Count
+            total.SumNs += h.SumNs
+            for slot := range h.Slots {
+                total.Slots[slot] += h.Slots[slot]
+            }
+        }
+        CgroupRunqLatency.Set(total.Count, total.SumNs, total.Slots[:], path, "111")
+    }
+    if err := iter.Err(); err != nil {
+        return fmt.Errorf("遍历 runq_cgroup_hist 出错: %v", err)
+    }
+
+    // 已删除的 cgroup 从 map 中移除，给新的 cgroup 腾出位置
+    for _, id := range gone {
+        r.cgroupMap.Delete(id)
+    }
+    return nil
+}
@@ -0,0 +1,255 @@
+package exporter
+
+import (
+    "encoding/json"
+    "errors"
+    "fmt"
+    "log"
+    "net/http"
+    "os"
+    "strconv"
+    "sync"
+    "syscall"
+    "time"
+    "unsafe"
+
+    "github.com/cilium/ebpf"
+    "github.com/cilium/ebpf/ringbuf"
+)
+
+// 超过阈值的软中断事件：内核通过 softirq_events ringbuf 逐条上报，
+// 这里在后台 goroutine 中消费并保留最近的若干条，通过 HTTP 查询。
+const (
+    softirqOutlierHistory     = 1024
+    defaultSoftirqThresholdUs = 1000
+    minSoftirqThresholdUs     = 100              // 更小的阈值下大部分软中断都会上报，会把 ringbuf 打满，按此抬高
+    maxSoftirqThresholdUs     = 60 * 1000 * 1000 // 单次软中断不可能运行这么久，更大的值按此截断
+    softirqReadBackoffMin     = 10 * time.Millisecond
+    softirqReadBackoffMax     = time.Second
+    SoftirqOutlierHTTPPath    = "/softirq/outliers"
+)
+
+// 对应 cpu_softirq_monitor.h 中的 struct softirq_event
+type softirqEvent struct {
+    TimestampNs uint64
+    DurationNs  uint64
+    Cpu         uint32
+    Vec         uint32
+}
+
+type SoftirqOutlier struct {
+    Time        time.Time `json:"time"`
+    MonotonicNs uint64    `json:"monotonic_ns"`
+    Cpu         uint32    `json:"cpu"`
+    Softirq     string    `json:"softirq"`
+    DurationUs  float64   `json:"duration_us"`
+}
+
+type SoftirqOutlierStream struct {
+    reader       *ringbuf.Reader
+    thresholdMap *ebpf.Map
+    dropsMap     *ebpf.Map
+    bootOffset   int64 // CLOCK_REALTIME - CLOCK_MONOTONIC，用于把内核时间戳换算为墙上时间
+
+    mu        sync.Mutex
+    history   [softirqOutlierHistory]SoftirqOutlier // 环形保存最近的事件
+    next      int
+    total     uint64
+    threshold uint64
+}
+
+func monotonicNs() int64 {
+    var ts syscall.Timespec
+    // CLOCK_MONOTONIC = 1，与 bpf_ktime_get_ns 同源
+    syscall.Syscall(syscall.SYS_CLOCK_GETTIME, 1, uintptr(unsafe.Pointer(&ts)), 0)
+    return ts.Nano()
+}
+
+func newSoftirqOutlierStream(coll *ebpf.Collection) (*SoftirqOutlierStream, error) {
+    events, ok := coll.Maps["softirq_events"]
+    if !ok {
+        return nil, fmt.Errorf("could not find softirq_events map")
+    }
+    thresholdMap, ok := coll.Maps["softirq_outlier_threshold"]
+    if !ok {
+        return nil, fmt.Errorf("could not find softirq_outlier_threshold map")
+    }
+    dropsMap, ok := coll.Maps["softirq_event_drops"]
+    if !ok {
+        return nil, fmt.Errorf("could not find softirq_event_drops map")
+    }
+
+    reader, err := ringbuf.NewReader(events)
+    if err != nil {
+        return nil, fmt.Errorf("failed to open softirq ringbuf: %v", err)
+    }
+    s := &SoftirqOutlierStream{
+        reader:       reader,
+        thresholdMap: thresholdMap,
+        dropsMap:     dropsMap,
+        bootOffset:   time.Now().UnixNano() - monotonicNs(),
+    }
+
+    thresholdUs := uint64(defaultSoftirqThresholdUs)
+    if v := os.Getenv("SOFTIRQ_OUTLIER_THRESHOLD_US"); v != "" {
+        parsed, err := strconv.ParseUint(v, 10, 64)
+        if err != nil {
+            log.Printf("忽略非法的 SOFTIRQ_OUTLIER_THRESHOLD_US=%q，使用默认值 %dus: %v", v, thresholdUs, err)
+        } else {
+            thresholdUs = parsed
+        }
+    }
+    if err := s.SetThreshold(softirqThresholdNs(thresholdUs)); err != nil {
+        reader.Close()
+        return nil, err
+    }
+
+    go s.run()
+    return s, nil
+}
+
+// softirqThresholdNs 把微秒阈值换算为纳秒，先限制到 [minSoftirqThresholdUs, maxSoftirqThresholdUs]，
+// 截断上限也避免了乘法溢出后变成一个很小的阈值；0 表示关闭，原样保留
+func softirqThresholdNs(thresholdUs uint64) uint64 {
+    if thresholdUs > 0 && thresholdUs < minSoftirqThresholdUs {
+        log.Printf("softirq 超时阈值 %dus 过小，提高到 %dus", thresholdUs, uint64(minSoftirqThresholdUs))
+        thresholdUs = minSoftirqThresholdUs
+    }
+    if thresholdUs > maxSoftirqThresholdUs {
+        log.Printf("softirq 超时阈值 %dus 过大，截断为 %dus", thresholdUs, uint64(maxSoftirqThresholdUs))
+        thresholdUs = maxSoftirqThresholdUs
+    }
+    return thresholdUs * 1000
+}
+
+// SetThreshold 更新内核侧阈值（纳秒），0 关闭事件流，立即对下一次软中断生效
+func (s *SoftirqOutlierStream) SetThreshold(thresholdNs uint64) error {
+    var key uint32
+    if err := s.thresholdMap.Update(key, thresholdNs, ebpf.UpdateAny); err != nil {
+        return fmt.Errorf("failed to set softirq outlier threshold: %v", err)
+    }
+    s.mu.Lock()
+    s.threshold = thresholdNs
+    s.mu.Unlock()
+    softirqOutlierThreshold.WithLabelValues("111").Set(float64(thresholdNs) / 1e9)
+    return nil
+}
+
+// run 阻塞在 ringbuf 上：Reader 内部用 epoll 等待，被唤醒后把环里已有的记录全部读完才会再次等待，
+// 每条记录复用同一个 Record 缓冲区。读取出错时按指数退避重试（最长 softirqReadBackoffMax），
+// 避免持续出错时空转并刷满日志，读到记录后恢复
+func (s *SoftirqOutlierStream) run() {
+    var record ringbuf.Record
+    var backoff time.Duration
+    for {
+        if err := s.reader.ReadInto(&record); err != nil {
+            if errors.Is(err, os.ErrClosed) {
+                return
+            }
+            if backoff == 0 {
+                backoff = softirqReadBackoffMin
+            } else if backoff < softirqReadBackoffMax {
+                backoff *= 2
+                if backoff > softirqReadBackoffMax {
+                    backoff = softirqReadBackoffMax
+                }
+            }
+            log.Printf("读取 softirq ringbuf 失败，%v 后重试: %v", backoff, err)
+            time.Sleep(backoff)
+            continue
+        }
+        backoff = 0
+        if len(record.RawSample) < int(unsafe.Sizeof(softirqEvent{})) {
+            continue
+        }
+        event := *(*softirqEvent)(unsafe.Pointer(&record.RawSample[0]))
+        s.record(&event)
+    }
+}
+
+func (s *SoftirqOutlierStream) record(event *softirqEvent) {
+    name := getSoftirqTypeName(event.Vec)
+    softirqOutlierEvents.WithLabelValues(name, "111").Inc()
+
+    s.mu.Lock()
+    s.history[s.next] = SoftirqOutlier{
+        Time:        time.Unix(0, s.bootOffset+int64(event.TimestampNs)),
+        MonotonicNs: event.TimestampNs,
+        Cpu:         event.Cpu,
+        Softirq:     name,
+        DurationUs:  float64(event.DurationNs) / 1e3,
+    }
+    s.next = (s.next + 1) % softirqOutlierHistory
+    s.total++
+    s.mu.Unlock()
+}
+
+// UpdateDrops 汇总各 CPU 上因 ringbuf 已满而丢弃的事件数
+func (s *SoftirqOutlierStream) UpdateDrops() error {
+    var key uint32
+    var perCPU []uint64
+    if err := s.dropsMap.Lookup(key, &perCPU); err != nil {
+        return fmt.Errorf("failed to read softirq_event_drops: %v", err)
+    }
+    var drops uint64
+    for _, v := range perCPU {
+        drops += v
+    }
+    softirqOutlierDrops.Set(drops, "111")
+    return nil
+}
+
+// Recent 按从新到旧返回最多 limit 条事件
+func (s *SoftirqOutlierStream) Recent(limit int) []SoftirqOutlier {
+    s.mu.Lock()
+    defer s.mu.Unlock()
+
+    n := softirqOutlierHistory
+    if s.total < uint64(n) {
+        n = int(s.total)
+    }
+    if limit > 0 && limit < n {
+        n = limit
+    }
+    out := make([]SoftirqOutlier, 0, n)
+    for i := 1; i <= n; i++ {
+        out = append(out, s.history[(s.next-i+softirqOutlierHistory)%softirqOutlierHistory])
+    }
+    return out
+}
+
+func (s *SoftirqOutlierStream) Close() {
+    s.reader.Close()
+}
+
+// ServeHTTP GET 返回最近的事件（?limit=N），POST/PUT 带 ?threshold_us=N 调整阈值（0 关闭），响应中是限制后实际生效的阈值
+func (s *SoftirqOutlierStream) ServeHTTP(w http.ResponseWriter, r *http.Request) {
+    switch r.Method {
+    case http.MethodPost, http.MethodPut:
+        thresholdUs, err := strconv.ParseUint(r.URL.Query().Get("threshold_us"), 10, 64)
+        if err != nil {
+            http.Error(w, "threshold_us must be an unsigned integer", http.StatusBadRequest)
+            return
+        }
+        if err := s.SetThreshold(softirqThresholdNs(thresholdUs)); err != nil {
+            http.Error(w, err.Error(), http.StatusInternalServerError)
+            return
+        }
+    case http.MethodGet:
+    default:
+        http.Error(w, "method not allowed", http.StatusMethodNotAllowed)
+        return
+    }
+
+    limit, _ := strconv.Atoi(r.URL.Query().Get("limit"))
+    s.mu.Lock()
+    threshold, total := s.threshold, s.total
+    s.mu.Unlock()
+
+    w.Header().Set("Content-Type", "application/json")
+    json.NewEncoder(w).Encode(struct {
+        ThresholdUs float64          `json:"threshold_us"`
+        Total       uint64           `json:"total"`
+        Events      []SoftirqOutlier `json:"events"`
+    }{float64(threshold) / 1e3, total, s.Recent(limit)})
+}
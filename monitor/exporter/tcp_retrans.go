@@ -0,0 +1,143 @@
+package exporter
+
+import (
+    "fmt"
+    "net"
+    "strconv"
+    "sync"
+
+    "github.com/cilium/ebpf"
+    "github.com/prometheus/client_golang/prometheus"
+)
+
+// TCP 重传与 srtt：tcp_retrans_monitor 按对端子网或服务端口在每个 CPU 上累计，
+// UpdateTcpRetransMetrics 读取 map 后把各 CPU 求和的快照保存在这里，抓取时生成常量指标（srtt 直方图见 log2Histogram）。
+type tcpRetransCollector struct {
+    retransDesc *prometheus.Desc
+    dropsDesc   *prometheus.Desc
+    rtt         *log2Histogram
+
+    mu      sync.Mutex
+    entries map[tcpPeerKey]*tcpRetransEntry
+    drops   uint64
+    epoch   uint64  // Update 的轮次，用于找出已被 LRU 淘汰的对端
+}
+
+type tcpRetransEntry struct {
+    peer string
+    stat tcpPeerStat
+    seen uint64     // 最近一次在 tcp_peer_stats 中出现的轮次
+}
+
+func newTcpRetransCollector() *tcpRetransCollector {
+    c := &tcpRetransCollector{
+        retransDesc: prometheus.NewDesc(
+            "ebpf_tcp_retransmits_total",
+            "tcp segments retransmitted, by remote subnet or service port",
+            []string{"peer", "node"}, nil,
+        ),
+        dropsDesc: prometheus.NewDesc(
+            "ebpf_tcp_peer_drops_total",
+            "tcp retransmit/rtt events dropped because no tcp_peer_stats entry could be allocated",
+            []string{"node"}, nil,
+        ),
+        rtt: newLog2Histogram(
+            "ebpf_tcp_srtt_microseconds",
+            "sampled smoothed rtt (tcp_sock.srtt_us) on ack processing, by remote subnet or service port",
+            []string{"peer", "node"}, tcpRttSlots, 1,
+        ),
+        entries: make(map[tcpPeerKey]*tcpRetransEntry),
+    }
+    return c
+}
+
+// tcpPeerLabel 按子网统计时为 "10.0.1.0/24"，按端口统计时为 "port:443"
+func tcpPeerLabel(key *tcpPeerKey, ipv4Prefix, ipv6Prefix int) string {
+    if key.Port != 0 {
+        return "port:" + strconv.Itoa(int(key.Port))
+    }
+    if key.Family == 6 {
+        return fmt.Sprintf("%s/%d", net.IP(key.Addr[:]).String(), ipv6Prefix)
+    }
+    return fmt.Sprintf("%s/%d", net.IP(key.Addr[:4]).String(), ipv4Prefix)
+}
+
+type TcpRetransMonitor struct {
+    statsMap   *ebpf.Map
+    dropsMap   *ebpf.Map
+    ipv4Prefix int
+    ipv6Prefix int
+}
+
+// Update 读取 tcp_peer_stats 并把各 CPU 的值求和后交给 collector；
+// 本轮不在 map 中的对端（已被 LRU 淘汰）连同其指标一起删除，避免标签无限累积
+func (t *TcpRetransMonitor) Update(c *tcpRetransCollector) error {
+    var key tcpPeerKey
+    var perCPU []tcpPeerStat
+
+    c.mu.Lock()
+    defer c.mu.Unlock()
+
+    c.epoch++
+
+    iter := t.statsMap.Iterate()
+    for iter.Next(&key, &perCPU) {
+        entry, ok := c.entries[key]
+        if !ok {
+            entry = &tcpRetransEntry{peer: tcpPeerLabel(&key, t.ipv4Prefix, t.ipv6Prefix)}
+            c.entries[key] = entry
+        }
+        entry.seen = c.epoch
+        entry.stat = tcpPeerStat{}
+        for cpu := range perCPU {
+            s := &perCPU[cpu]
+            entry.stat.Retransmits += s.Retransmits
+            entry.stat.RttSamples += s.RttSamples
+            entry.stat.RttSumUs += s.RttSumUs
+            for slot := range s.RttHist {
+                entry.stat.RttHist[slot] += s.RttHist[slot]
+            }
+        }
+        if entry.stat.RttSamples > 0 {
+            c.rtt.Set(entry.stat.RttSamples, entry.stat.RttSumUs, entry.stat.RttHist[:], entry.peer, "111")
+        }
+    }
+    if err := iter.Err(); err != nil {
+        return fmt.Errorf("遍历 tcp_peer_stats 出错: %v", err)
+    }
+    for key, entry := range c.entries {
+        if entry.seen != c.epoch {
+            c.rtt.Delete(entry.peer, "111")
+            delete(c.entries, key)
+        }
+    }
+
+    var index uint32
+    var drops []uint64
+    if err := t.dropsMap.Lookup(index, &drops); err != nil {
+        return fmt.Errorf("failed to read tcp_peer_drops: %v", err)
+    }
+    c.drops = 0
+    for _, v := range drops {
+        c.drops += v
+    }
+    return nil
+}
+
+func (c *tcpRetransCollector) Describe(ch chan<- *prometheus.Desc) {
+    ch <- c.retransDesc
+    ch <- c.dropsDesc
+    c.rtt.Describe(ch)
+}
+
+func (c *tcpRetransCollector) Collect(ch chan<- prometheus.Metric) {
+    c.mu.Lock()
+    defer c.mu.Unlock()
+
+    for _, entry := range c.entries {
+        ch <- prometheus.MustNewConstMetric(c.retransDesc, prometheus.CounterValue,
+            float64(entry.stat.Retransmits), entry.peer, "111")
+    }
+    ch <- prometheus.MustNewConstMetric(c.dropsDesc, prometheus.CounterValue, float64(c.drops), "111")
+    c.rtt.Collect(ch)
+}
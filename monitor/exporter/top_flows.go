@@ -0,0 +1,197 @@
+package exporter
+
+import (
+    "fmt"
+    "net"
+    "sort"
+    "strconv"
+    "time"
+
+    "github.com/cilium/ebpf"
+    "github.com/prometheus/client_golang/prometheus"
+)
+
+// 大流量检测：net_monitor 在每个 CPU 上维护 count-min sketch 和按槽位替换的候选表（见 net_monitor.h），
+// 这里每个周期切换一次 epoch，读取上一周期各 CPU 的候选并合并，按字节和包数各取前 N 条流导出速率。
+// 开启后每个包都要多更新一次 sketch，因此默认关闭，由 NET_MONITOR_TOP_FLOWS 显式开启。
+
+type flowTotal struct {
+    key     netFlowKey
+    bytes   uint64
+    packets uint64
+}
+
+type TopFlows struct {
+    configMap *ebpf.Map
+    sketchMap *ebpf.Map
+    topkMap   *ebpf.Map
+    topN      int
+
+    epoch      uint32
+    lastSwitch time.Time
+    perCPU     []flowTopK   // 读缓冲区
+    zeroTopK   []flowTopK   // 清零用的全零值，长度为 CPU 数
+    zeroRows   []flowCmsRow
+    merged     map[netFlowKey]*flowTotal
+    ranked     []*flowTotal
+    topBytes   map[netFlowKey]bool  // 上一次导出的前 N 名
+    topPackets map[netFlowKey]bool
+}
+
+func newTopFlows(configMap, sketchMap, topkMap *ebpf.Map, topN int) (*TopFlows, error) {
+    t := &TopFlows{
+        configMap:  configMap,
+        sketchMap:  sketchMap,
+        topkMap:    topkMap,
+        topN:       topN,
+        lastSwitch: time.Now(),
+        merged:     make(map[netFlowKey]*flowTotal),
+    }
+    if err := t.setConfig(true); err != nil {
+        return nil, err
+    }
+    return t, nil
+}
+
+func (t *TopFlows) setConfig(enabled bool) error {
+    var key uint32
+    config := flowConfig{Epoch: t.epoch}
+    if enabled {
+        config.Enabled = 1
+    }
+    if err := t.configMap.Update(key, config, ebpf.UpdateAny); err != nil {
+        return fmt.Errorf("failed to update flow_config: %v", err)
+    }
+    return nil
+}
+
+// Update 切换到另一份 sketch，合并刚结束的周期中各 CPU 的候选流并更新前 N 名，再把这一份清零留给下个周期
+func (t *TopFlows) Update() error {
+    prev := t.epoch & 1
+    t.epoch++
+    if err := t.setConfig(true); err != nil {
+        return err
+    }
+    now := time.Now()
+    elapsed := now.Sub(t.lastSwitch).Seconds()
+    t.lastSwitch = now
+
+    if err := t.topkMap.Lookup(prev, &t.perCPU); err != nil {
+        return fmt.Errorf("failed to read flow_topk: %v", err)
+    }
+    t.merge()
+    if err := t.reset(prev); err != nil {
+        return err
+    }
+    if elapsed > 0 {
+        t.export(elapsed)
+    }
+    return nil
+}
+
+// merge 汇总各 CPU 的估计值：同一 CPU 上两张表的同一槽位可能是同一条流，只计一次
+func (t *TopFlows) merge() {
+    for key := range t.merged {
+        delete(t.merged, key)
+    }
+    add := func(c *flowCandidate) {
+        if c.Bytes == 0 || c.Key.L3Proto == 0 {
+            return
+        }
+        total, ok := t.merged[c.Key]
+        if !ok {
+            total = &flowTotal{key: c.Key}
+            t.merged[c.Key] = total
+        }
+        total.bytes += c.Bytes
+        total.packets += c.Packets
+    }
+    for cpu := range t.perCPU {
+        topk := &t.perCPU[cpu]
+        for slot := 0; slot < flowTopKSlots; slot++ {
+            byBytes, byPackets := topk.ByBytes[slot], topk.ByPackets[slot]
+            if byBytes.Key == byPackets.Key {
+                // 两张表的更新时刻不同，取较新的（更大的）估计值
+                if byPackets.Bytes > byBytes.Bytes {
+                    byBytes.Bytes = byPackets.Bytes
+                }
+                if byPackets.Packets > byBytes.Packets {
+                    byBytes.Packets = byPackets.Packets
+                }
+                add(&byBytes)
+                continue
+            }
+            add(&byBytes)
+            add(&byPackets)
+        }
+    }
+}
+
+func (t *TopFlows) reset(epoch uint32) error {
+    if len(t.zeroTopK) != len(t.perCPU) {
+        t.zeroTopK = make([]flowTopK, len(t.perCPU))
+        t.zeroRows = make([]flowCmsRow, len(t.perCPU))
+    }
+    if err := t.topkMap.Update(epoch, t.zeroTopK, ebpf.UpdateAny); err != nil {
+        return fmt.Errorf("failed to reset flow_topk: %v", err)
+    }
+    for row := uint32(0); row < flowCmsDepth; row++ {
+        if err := t.sketchMap.Update(epoch*flowCmsDepth+row, t.zeroRows, ebpf.UpdateAny); err != nil {
+            return fmt.Errorf("failed to reset flow_sketch: %v", err)
+        }
+    }
+    return nil
+}
+
+// export 用本周期的流量除以周期长度得到速率
+func (t *TopFlows) export(elapsed float64) {
+    t.ranked = t.ranked[:0]
+    for _, total := range t.merged {
+        t.ranked = append(t.ranked, total)
+    }
+
+    sort.Slice(t.ranked, func(i, j int) bool { return t.ranked[i].bytes > t.ranked[j].bytes })
+    t.topBytes = t.exportRanked(topFlowBytes, t.topBytes, func(f *flowTotal) uint64 { return f.bytes }, elapsed)
+
+    sort.Slice(t.ranked, func(i, j int) bool { return t.ranked[i].packets > t.ranked[j].packets })
+    t.topPackets = t.exportRanked(topFlowPackets, t.topPackets, func(f *flowTotal) uint64 { return f.packets }, elapsed)
+}
+
+// exportRanked 写入排好序的 t.ranked 中前 N 条流，再删除上一次导出、这次跌出前 N 名的流，返回这次导出的流；
+// 先 Reset 再写入会让期间的抓取看不到任何流
+func (t *TopFlows) exportRanked(vec *prometheus.GaugeVec, prev map[netFlowKey]bool,
+    value func(*flowTotal) uint64, elapsed float64) map[netFlowKey]bool {
+    top := make(map[netFlowKey]bool, t.topN)
+    for i := 0; i < len(t.ranked) && i < t.topN; i++ {
+        f := t.ranked[i]
+        top[f.key] = true
+        vec.WithLabelValues(flowLabels(&f.key)...).Set(float64(value(f)) / elapsed)
+    }
+    for key := range prev {
+        if !top[key] {
+            vec.DeleteLabelValues(flowLabels(&key)...)
+        }
+    }
+    return top
+}
+
+// Close 关闭内核侧的大流量统计
+func (t *TopFlows) Close() error {
+    return t.setConfig(false)
+}
+
+// flowLabels 返回 src, dst, sport, dport, proto, node
+func flowLabels(key *netFlowKey) []string {
+    var src, dst net.IP
+    if key.L3Proto == 4 {
+        src, dst = net.IP(key.Saddr[:4]), net.IP(key.Daddr[:4])
+    } else {
+        src, dst = net.IP(key.Saddr[:]), net.IP(key.Daddr[:])
+    }
+    proto, ok := TrafficL4Names[key.L4Proto]
+    if !ok || key.L4Proto == 255 {
+        proto = strconv.Itoa(int(key.L4Proto))
+    }
+    return []string{src.String(), dst.String(), strconv.Itoa(int(key.Sport)),
+        strconv.Itoa(int(key.Dport)), proto, "111"}
+}
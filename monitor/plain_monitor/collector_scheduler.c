@@ -0,0 +1,168 @@
+#include "collector_scheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#define NSEC_PER_SEC 1000000000ULL
+#define MAX_EVENTS 16
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static struct timespec ns_to_timespec(uint64_t ns) {
+    struct timespec ts = {
+        .tv_sec = (time_t)(ns / NSEC_PER_SEC),
+        .tv_nsec = (long)(ns % NSEC_PER_SEC),
+    };
+    return ts;
+}
+
+int collector_scheduler_init(CollectorScheduler *sched) {
+    memset(sched, 0, sizeof(*sched));
+    sched->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (sched->epoll_fd < 0) {
+        perror("epoll_create1");
+        return -1;
+    }
+    sched->start_ns = monotonic_ns();
+    return 0;
+}
+
+void collector_scheduler_destroy(CollectorScheduler *sched) {
+    for (int i = 0; i < sched->count; i++) {
+        if (sched->collectors[i].timer_fd >= 0) close(sched->collectors[i].timer_fd);
+    }
+    free(sched->collectors);
+    if (sched->epoll_fd >= 0) close(sched->epoll_fd);
+    memset(sched, 0, sizeof(*sched));
+    sched->epoll_fd = -1;
+}
+
+static int collector_reserve(CollectorScheduler *sched) {
+    if (sched->count == sched->capacity) {
+        int new_capacity = sched->capacity ? sched->capacity * 2 : 4;
+        Collector *collectors = realloc(sched->collectors, (size_t)new_capacity * sizeof(Collector));
+        if (!collectors) return -1;
+        sched->collectors = collectors;
+        sched->capacity = new_capacity;
+    }
+    return 0;
+}
+
+int collector_scheduler_add(CollectorScheduler *sched, const char *name, uint64_t period_ns,
+                            collector_fn collect, void *ctx) {
+    if (period_ns == 0 || !collect) return -1;
+    if (collector_reserve(sched) != 0) return -1;
+
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        perror("timerfd_create");
+        return -1;
+    }
+
+    // 绝对时间 + 固定间隔：内核按 start + k * period 推进到期时间，回调耗时不会累积成漂移
+    struct itimerspec spec = {
+        .it_value = ns_to_timespec(sched->start_ns + period_ns),
+        .it_interval = ns_to_timespec(period_ns),
+    };
+    if (timerfd_settime(fd, TFD_TIMER_ABSTIME, &spec, NULL) != 0) {
+        perror("timerfd_settime");
+        close(fd);
+        return -1;
+    }
+
+    int index = sched->count;
+    struct epoll_event ev = { .events = EPOLLIN, .data.u32 = (uint32_t)index };
+    if (epoll_ctl(sched->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        perror("epoll_ctl");
+        close(fd);
+        return -1;
+    }
+
+    Collector *c = &sched->collectors[index];
+    memset(c, 0, sizeof(*c));
+    c->name = name;
+    c->collect = collect;
+    c->ctx = ctx;
+    c->period_ns = period_ns;
+    c->timer_fd = fd;
+    c->event_fd = -1;
+    sched->count++;
+    return index;
+}
+
+int collector_scheduler_add_fd(CollectorScheduler *sched, const char *name, int fd, uint32_t events,
+                               collector_fn collect, void *ctx) {
+    if (fd < 0 || !collect) return -1;
+    if (collector_reserve(sched) != 0) return -1;
+
+    int index = sched->count;
+    struct epoll_event ev = { .events = events, .data.u32 = (uint32_t)index };
+    if (epoll_ctl(sched->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        perror("epoll_ctl");
+        return -1;
+    }
+
+    Collector *c = &sched->collectors[index];
+    memset(c, 0, sizeof(*c));
+    c->name = name;
+    c->collect = collect;
+    c->ctx = ctx;
+    c->timer_fd = -1;
+    c->event_fd = fd;
+    sched->count++;
+    return index;
+}
+
+static void collector_run_once(Collector *c) {
+    uint64_t expirations = 0;
+
+    // 事件驱动的采集器没有 timerfd，每次唤醒都执行回调
+    if (c->timer_fd >= 0) {
+        if (read(c->timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+            return;  // EAGAIN：被其他事件提前唤醒，尚未到期
+        }
+        // 一次唤醒对应多次到期，说明上一个周期的回调或其他采集器占用了太久
+        if (expirations > 1) c->overruns += expirations - 1;
+    }
+
+    uint64_t begin = monotonic_ns();
+    if (c->collect(c->ctx) != 0) c->failures++;
+    uint64_t duration = monotonic_ns() - begin;
+
+    c->runs++;
+    c->last_duration_ns = duration;
+    if (duration > c->max_duration_ns) c->max_duration_ns = duration;
+}
+
+int collector_scheduler_run(CollectorScheduler *sched) {
+    struct epoll_event events[MAX_EVENTS];
+
+    while (!sched->stop) {
+        int n = epoll_wait(sched->epoll_fd, events, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            return -1;
+        }
+        for (int i = 0; i < n && !sched->stop; i++) {
+            uint32_t index = events[i].data.u32;
+            if (index < (uint32_t)sched->count) {
+                collector_run_once(&sched->collectors[index]);
+            }
+        }
+    }
+    return 0;
+}
+
+void collector_scheduler_stop(CollectorScheduler *sched) {
+    sched->stop = 1;
+}
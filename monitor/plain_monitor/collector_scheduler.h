@@ -0,0 +1,54 @@
+#ifndef COLLECTOR_SCHEDULER_H
+#define COLLECTOR_SCHEDULER_H
+
+#include <stdint.h>
+#include <signal.h>
+
+// 采集回调，返回0表示成功
+typedef int (*collector_fn)(void *ctx);
+
+// 单个采集器及其运行统计
+typedef struct {
+    const char *name;            // 采集器名称
+    collector_fn collect;        // 采集回调
+    void *ctx;                   // 回调上下文
+    uint64_t period_ns;          // 采集周期，事件驱动的采集器为0
+    int timer_fd;                // 绝对时间的周期 timerfd，事件驱动的采集器为-1
+    int event_fd;                // 事件驱动的采集器等待的 fd（由调用方持有），周期采集器为-1
+    uint64_t runs;               // 执行次数
+    uint64_t overruns;           // 错过的周期数（一次唤醒时 timerfd 已到期多次）
+    uint64_t failures;           // 回调返回失败的次数
+    uint64_t last_duration_ns;   // 最近一次回调耗时
+    uint64_t max_duration_ns;    // 最长一次回调耗时
+} Collector;
+
+// 单线程调度器：一个 epoll 驱动所有采集器的 timerfd 与事件 fd，各采集器周期相互独立
+typedef struct {
+    int epoll_fd;
+    Collector *collectors;
+    int count;
+    int capacity;
+    uint64_t start_ns;           // 所有采集器共同的时间基准（CLOCK_MONOTONIC）
+    volatile sig_atomic_t stop;  // 置1后 run 返回，可在信号处理函数中设置
+} CollectorScheduler;
+
+int collector_scheduler_init(CollectorScheduler *sched);
+void collector_scheduler_destroy(CollectorScheduler *sched);
+
+// 注册采集器，deadline 固定为 start + k * period，不受回调耗时影响而漂移
+// 返回采集器下标，失败返回-1
+int collector_scheduler_add(CollectorScheduler *sched, const char *name, uint64_t period_ns,
+                            collector_fn collect, void *ctx);
+
+// 注册事件驱动的采集器：fd 上出现 events（水平触发）时调用 collect，回调需要消费掉事件，
+// 否则下一轮 epoll_wait 会立即再次返回。fd 由调用方关闭，返回采集器下标，失败返回-1
+int collector_scheduler_add_fd(CollectorScheduler *sched, const char *name, int fd, uint32_t events,
+                               collector_fn collect, void *ctx);
+
+// 运行事件循环直到 collector_scheduler_stop，返回0；epoll 出错返回-1
+int collector_scheduler_run(CollectorScheduler *sched);
+
+// 请求停止事件循环（异步信号安全）
+void collector_scheduler_stop(CollectorScheduler *sched);
+
+#endif // COLLECTOR_SCHEDULER_H
@@ -1,55 +1,135 @@
 #include "cpu_load_monitor.h"
+#include "proc_parser.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <math.h>
+#include <time.h>
 #include <sys/sysinfo.h>
 #include <ctype.h>
 
+// 每隔这么多次调用重新获取一次CPU核心数，CPU 热插拔后最多滞后这么多个采样周期
+#define CPU_COUNT_REFRESH_CALLS 60
+
+// /proc/loadavg 常驻句柄，避免每次采样都 fopen/fclose
+static ProcFile loadavg_file = PROC_FILE_INIT("/proc/loadavg");
+
+// /proc/stat 常驻句柄，供负载估计器高频采样
+static ProcFile stat_file = PROC_FILE_INIT("/proc/stat");
+
+// sysconf(_SC_NPROCESSORS_ONLN) 每次都要读取 /sys/devices/system/cpu/online，缓存结果
+static int cached_cpu_count;
+static int cpu_count_calls;
+
+static int get_cpu_count(void) {
+    if (cached_cpu_count <= 0 || ++cpu_count_calls >= CPU_COUNT_REFRESH_CALLS) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        cached_cpu_count = n > 0 ? (int)n : 1; // 保守默认值
+        cpu_count_calls = 0;
+    }
+    return cached_cpu_count;
+}
+
 // 从/proc/loadavg解析平均负载
-static int parse_loadavg(const char *line, LoadAvgData *data) {
+static int parse_loadavg(const char *line, const char *end, LoadAvgData *data) {
     // 格式: "1.23 4.56 7.89 1/123 45678"
     // 我们只需要前三个浮点数
-    int result = sscanf(line, "%lf %lf %lf", 
-                       &data->load_1min, 
-                       &data->load_5min, 
-                       &data->load_15min);
-    
-    if (result != 3) {
-        return -1;
-    }
+    const char *p = line;
+
+    if (!(p = proc_parse_decimal(p, end, &data->load_1min))) return -1;
+    if (!(p = proc_parse_decimal(p, end, &data->load_5min))) return -1;
+    if (!(p = proc_parse_decimal(p, end, &data->load_15min))) return -1;
     return 0;
 }
 
 // 获取并计算负载数据
-void get_loadavg_data(LoadAvgData *data) {
-    FILE *fp = fopen("/proc/loadavg", "r");
-    if (!fp) {
-        perror("Failed to open /proc/loadavg");
-        exit(1);
-    }
+int get_loadavg_data(LoadAvgData *data) {
+    LoadAvgData parsed;
 
-    char line[256];
-    if (!fgets(line, sizeof(line), fp)) {
+    if (proc_file_read(&loadavg_file) < 0) {
         fprintf(stderr, "Failed to read /proc/loadavg\n");
-        exit(1);
+        return -1;
     }
-    fclose(fp);
 
-    // 解析系统平均负载
-    if (parse_loadavg(line, data) != 0) {
-        exit(1);
+    // 解析系统平均负载，先解析到临时变量，失败时保留调用方上一次的结果
+    if (parse_loadavg(loadavg_file.buf, loadavg_file.buf + loadavg_file.len, &parsed) != 0) {
+        fprintf(stderr, "Failed to parse /proc/loadavg\n");
+        return -1;
     }
+    data->load_1min = parsed.load_1min;
+    data->load_5min = parsed.load_5min;
+    data->load_15min = parsed.load_15min;
 
     // 获取CPU核心数
-    data->cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
-    if (data->cpu_count <= 0) {
-        data->cpu_count = 1; // 保守默认值
-    }
-    // printf("cpu num: %d", data->cpu_count);
+    data->cpu_count = get_cpu_count();
 
     // 计算每核心的负载
     data->load_1min_per_core = data->load_1min / data->cpu_count;
     data->load_5min_per_core = data->load_5min / data->cpu_count;
     data->load_15min_per_core = data->load_15min / data->cpu_count;
-}
\ No newline at end of file
+    return 0;
+}
+
+void load_estimator_init(LoadEstimator *est) {
+    memset(est, 0, sizeof(*est));
+}
+
+// 按实际采样间隔计算衰减系数，采样被推迟时不会低估旧值的衰减
+static double ewma(double value, double sample, double dt_sec, double tau_sec) {
+    return value + (1.0 - exp(-dt_sec / tau_sec)) * (sample - value);
+}
+
+void load_estimator_update(LoadEstimator *est, unsigned long running, unsigned long blocked,
+                           uint64_t now_ns) {
+    double sample = (double)(running + blocked);
+
+    est->procs_running = running;
+    est->procs_blocked = blocked;
+    if (est->last_ns == 0 || now_ns <= est->last_ns) {
+        if (est->last_ns == 0) {
+            est->load_1s = est->load_10s = est->load_60s = sample;
+        }
+        est->last_ns = now_ns;
+        return;
+    }
+
+    double dt = (double)(now_ns - est->last_ns) / 1e9;
+    est->load_1s = ewma(est->load_1s, sample, dt, 1.0);
+    est->load_10s = ewma(est->load_10s, sample, dt, 10.0);
+    est->load_60s = ewma(est->load_60s, sample, dt, 60.0);
+    est->last_ns = now_ns;
+}
+
+// 在 /proc/stat 中查找 procs_running 与 procs_blocked（位于 cpu 与 intr 行之后）
+static int parse_procs(const char *buf, const char *end, unsigned long *running, unsigned long *blocked) {
+    int found = 0;
+
+    for (const char *line = buf; line < end && found != 3; line = proc_next_line(line, end)) {
+        if (*line != 'p' || end - line < 14 || memcmp(line, "procs_", 6) != 0) continue;
+        if (memcmp(line + 6, "running ", 8) == 0) {
+            if (proc_parse_ulong(line + 14, end, running)) found |= 1;
+        } else if (memcmp(line + 6, "blocked ", 8) == 0) {
+            if (proc_parse_ulong(line + 14, end, blocked)) found |= 2;
+        }
+    }
+    return found == 3 ? 0 : -1;
+}
+
+int load_estimator_sample(LoadEstimator *est) {
+    unsigned long running = 0, blocked = 0;
+    struct timespec ts;
+
+    if (proc_file_read(&stat_file) < 0) return -1;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    if (parse_procs(stat_file.buf, stat_file.buf + stat_file.len, &running, &blocked) != 0) {
+        fprintf(stderr, "Failed to parse procs_running/procs_blocked in /proc/stat\n");
+        return -1;
+    }
+
+    // 读取 /proc/stat 的线程自身处于运行状态
+    if (running > 0) running--;
+    load_estimator_update(est, running, blocked,
+                          (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+    return 0;
+}
@@ -12,9 +12,36 @@ typedef struct {
     double load_1min_per_core; // 每个核心的1分钟平均负载
     double load_5min_per_core; // 每个核心的5分钟平均负载
     double load_15min_per_core; // 每个核心的15分钟平均负载
+    double load_1s;         // LoadEstimator 的 1秒/10秒/60秒 负载，未启用估计器时为0
+    double load_10s;
+    double load_60s;
 } LoadAvgData;
 
-// 获取系统负载数据的接口
-void get_loadavg_data(LoadAvgData *data);
+// 获取系统负载数据的接口，读取或解析 /proc/loadavg 失败返回-1（不修改 data）
+int get_loadavg_data(LoadAvgData *data);
 
-#endif // CPU_LOAD_MONITOR_H
\ No newline at end of file
+// 亚秒级负载估计器
+// /proc/loadavg 最短的窗口是 1 分钟，且内核每 5 秒才采样一次。估计器由调用方按较高频率（如 100ms）
+// 采样 /proc/stat 的 procs_running 与 procs_blocked，对两者之和做时间常数为 1s/10s/60s 的指数滑动平均，
+// 与内核 loadavg 的衰减方式相同，只是窗口更短、采样更密。
+// 差异：procs_blocked 只统计等待 I/O 的任务，内核 loadavg 统计所有不可中断睡眠的任务；
+// procs_running 包含正在读取 /proc/stat 的采样线程自身，采样时减去1。
+typedef struct {
+    double load_1s;
+    double load_10s;
+    double load_60s;
+    unsigned long procs_running;    // 最近一次采样（不含采样线程自身）
+    unsigned long procs_blocked;
+    uint64_t last_ns;               // 最近一次采样的单调时钟时间（纳秒），0 表示尚未采样
+} LoadEstimator;
+
+void load_estimator_init(LoadEstimator *est);
+
+// 读取 /proc/stat 并更新估计值，失败返回-1
+int load_estimator_sample(LoadEstimator *est);
+
+// 用一次采样更新估计值（now_ns 为单调时钟）；第一次采样直接作为各窗口的初值
+void load_estimator_update(LoadEstimator *est, unsigned long running, unsigned long blocked,
+                           uint64_t now_ns);
+
+#endif // CPU_LOAD_MONITOR_H
@@ -4,7 +4,9 @@
 int main() {
     LoadAvgData data;
     
-    get_loadavg_data(&data);
+    if (get_loadavg_data(&data) != 0) {
+        return 1;
+    }
     
     printf("System Load Average:\n");
     printf("  1min:  %8.2f (system)\n", data.load_1min);
@@ -19,44 +19,54 @@
 #include <linux/miscdevice.h>    // 包含misc_register, misc_deregister
 #include <linux/sched.h>         // 包含kernel_cpustat
 #include <linux/printk.h>        // 包含_printk
+#include <linux/poll.h>          // 包含poll_wait
+#include <linux/wait.h>          // 包含wait_event_interruptible
 
 #if LINUX_VERSION_CODE < KERNEL_VERSION(5, 6, 0)    
 #error "This module requires Linux kernel version 5.6 or later"
 #endif
 
-#define MAX_CPU 128
-
-struct cpu_stat {
-    // char cpu_name[16];
-    u32 online;
-    u64 user;
-    u64 nice;
-    u64 system;
-    u64 idle;
-    u64 io_wait;
-    u64 irq;
-    u64 soft_irq;
-    u64 steal;
-    u64 guest;
-    u64 guest_nice;
-};
+#include "cpu_stat_ring.h"
+
+#define DEFAULT_PERIOD_US 1000000   // 默认1秒
+#define MIN_PERIOD_US 1000          // 最短1毫秒
+#define DEFAULT_RING_SLOTS 64
+#define MIN_RING_SLOTS 2
+#define MAX_RING_SLOTS 4096
+
+static unsigned int period_us = DEFAULT_PERIOD_US;
+module_param(period_us, uint, 0444);
+MODULE_PARM_DESC(period_us, "sampling period in microseconds (>= 1000)");
 
-static struct cpu_stat *g_cpu_stats = NULL;
+static unsigned int ring_slots = DEFAULT_RING_SLOTS;
+module_param(ring_slots, uint, 0444);
+MODULE_PARM_DESC(ring_slots, "number of samples kept in the mmap ring (2-4096)");
+
+static void *g_ring = NULL;             // vmalloc_user 分配，整页映射给用户态
+static size_t g_ring_size;
+static struct cpu_stat_ring_header *g_header;
 static struct hrtimer cpu_stat_timer;
 static ktime_t ktime;
-#define UPDATE_INTERVAL_NS 1000000000L  // 1秒 = 1000000000 纳秒
+static DECLARE_WAIT_QUEUE_HEAD(cpu_stat_wait);  // 等待新一代采样的读者
+
+// 每个打开的文件各自记录已经读到的代数
+struct cpu_stat_reader {
+    u64 seen_generation;
+};
 
+static struct cpu_stat_slot_header *ring_slot(u64 generation) {
+    u32 index = (u32)(generation % g_header->nr_slots);
+    return (struct cpu_stat_slot_header *)((char *)g_ring + g_header->slot_offset +
+                                           (size_t)index * g_header->slot_size);
+}
 
 static void update_cpu_stats(struct cpu_stat *stats) {
-    static int times = 0;
-    int cpu;
-    for (cpu = 0; cpu < MAX_CPU; ++cpu) {
+    unsigned int cpu;
+    for (cpu = 0; cpu < nr_cpu_ids; ++cpu) {
         if (!cpu_online(cpu)) {
             stats[cpu].online = 0;
-            // stats[cpu].cpu_name[0] = '\0';
             continue;
         }
-        // snprintf(stats[cpu].cpu_name, sizeof(stats[cpu].cpu_name), "cpu%d", cpu);
         u64 *stat = kcpustat_cpu(cpu).cpustat;
         stats[cpu].online = 1;
         stats[cpu].user = stat[CPUTIME_USER];
@@ -69,36 +79,114 @@ static void update_cpu_stats(struct cpu_stat *stats) {
         stats[cpu].steal = stat[CPUTIME_STEAL];
         stats[cpu].guest = stat[CPUTIME_GUEST];
         stats[cpu].guest_nice = stat[CPUTIME_GUEST_NICE];
-
-        printk(KERN_INFO "cpu_stat_monitor: CPU0 user=%llu, nice=%llu\n", 
-            stats[0].user, stats[0].nice);
     }
 }
 
+// 定时器回调是唯一的写端，按 cpu_stat_ring.h 中的顺序发布下一代采样
+static void publish_sample(void) {
+    u64 generation = g_header->generation + 1;
+    struct cpu_stat_slot_header *slot = ring_slot(generation);
+    u64 seq = slot->seq;
+
+    WRITE_ONCE(slot->seq, seq + 1);
+    smp_wmb();
+    update_cpu_stats((struct cpu_stat *)(slot + 1));
+    slot->generation = generation;
+    slot->timestamp_ns = ktime_get_ns();
+    smp_wmb();
+    WRITE_ONCE(slot->seq, seq + 2);
+    smp_store_release(&g_header->generation, generation);
+    // wq_has_sleeper 带内存屏障，与等待方的条件检查配对；没有读者时不碰等待队列锁
+    if (wq_has_sleeper(&cpu_stat_wait))
+        wake_up_interruptible_poll(&cpu_stat_wait, EPOLLIN | EPOLLRDNORM);
+}
+
 static enum hrtimer_restart cpu_stat_timer_callback(struct hrtimer *timer)
 {
-    update_cpu_stats(g_cpu_stats);
-    hrtimer_forward_now(timer, ktime);
+    u64 overruns;
+
+    publish_sample();
+    // 按固定周期推进到期时间，回调迟到时跳过的周期计入 missed
+    overruns = hrtimer_forward_now(timer, ktime);
+    if (overruns > 1)
+        WRITE_ONCE(g_header->missed, g_header->missed + overruns - 1);
     return HRTIMER_RESTART;
 }
 
 //vmalloc分配的是虚拟地址连续的大块内存，物理地址并不连续，内核通过修改页表，将虚拟地址拼接连续
 //virt_to_phys只能转换kmalloc等分配在直接映射区的内存地址，不能用于vmalloc或者zmalloc
 //remap_pfn_range作用是将一段连续物理内存映射至用户空间的虚拟地址
-//因此，virt_to_phys这里返回了失效虚拟地址，remap_pfn_range将其映射给了go，go是从无效地址读取数据
+//因此这里用 vmalloc_user 分配（已清零且按页对齐），再用 remap_vmalloc_range 逐页映射
 static int cpu_stat_monitor_mmap(struct file *filp, struct vm_area_struct *vma) {
-    unsigned long size = sizeof(struct cpu_stat) * MAX_CPU;
-    if ((vma->vm_end - vma->vm_start) < size)
+    unsigned long size = vma->vm_end - vma->vm_start;
+    if (vma->vm_pgoff != 0 || size > PAGE_ALIGN(g_ring_size))
         return -EINVAL;
-    // 移除 update_cpu_stats 调用,因为定时器会定期更新
-    return remap_pfn_range(vma, vma->vm_start,
-                           virt_to_phys((void *)g_cpu_stats) >> PAGE_SHIFT,                
-                           size, vma->vm_page_prot);
+    return remap_vmalloc_range(vma, g_ring, 0);
+}
+
+static u64 latest_generation(void) {
+    return smp_load_acquire(&g_header->generation);
+}
+
+// 打开时从当前代数开始，之后的 read/poll 只报告打开之后发布的采样
+static int cpu_stat_monitor_open(struct inode *inode, struct file *filp) {
+    struct cpu_stat_reader *reader = kzalloc(sizeof(*reader), GFP_KERNEL);
+    if (!reader)
+        return -ENOMEM;
+    reader->seen_generation = latest_generation();
+    filp->private_data = reader;
+    return 0;
+}
+
+static int cpu_stat_monitor_release(struct inode *inode, struct file *filp) {
+    kfree(filp->private_data);
+    return 0;
+}
+
+// read 阻塞到有比上次更新的一代采样，返回8字节的最新代数；
+// 两次 read 之间发布了多代时只返回最新一代，读者可用差值判断漏掉了几个采样（都还在环里）
+static ssize_t cpu_stat_monitor_read(struct file *filp, char __user *buf, size_t count, loff_t *ppos) {
+    struct cpu_stat_reader *reader = filp->private_data;
+    u64 generation;
+    int ret;
+
+    if (count < sizeof(generation))
+        return -EINVAL;
+
+    generation = latest_generation();
+    if (generation == reader->seen_generation) {
+        if (filp->f_flags & O_NONBLOCK)
+            return -EAGAIN;
+        ret = wait_event_interruptible(cpu_stat_wait,
+                                       latest_generation() != reader->seen_generation);
+        if (ret)
+            return ret;
+        generation = latest_generation();
+    }
+
+    if (copy_to_user(buf, &generation, sizeof(generation)))
+        return -EFAULT;
+    reader->seen_generation = generation;
+    return sizeof(generation);
+}
+
+static __poll_t cpu_stat_monitor_poll(struct file *filp, poll_table *wait) {
+    struct cpu_stat_reader *reader = filp->private_data;
+
+    poll_wait(filp, &cpu_stat_wait, wait);
+    if (latest_generation() != reader->seen_generation)
+        return EPOLLIN | EPOLLRDNORM;
+    return 0;
 }
 
 static const struct file_operations cpu_stat_monitor_fops = {
     .owner = THIS_MODULE,
+    .open = cpu_stat_monitor_open,
+    .release = cpu_stat_monitor_release,
+    .read = cpu_stat_monitor_read,
+    .poll = cpu_stat_monitor_poll,
     .mmap = cpu_stat_monitor_mmap,
+    .llseek = noop_llseek,
 };
 
 static struct miscdevice cpu_stat_monitor_dev = {
@@ -108,27 +196,68 @@ static struct miscdevice cpu_stat_monitor_dev = {
     .mode = 0444,
 };
 
-static int __init cpu_stat_monitor_init(void) {
-    g_cpu_stats = kzalloc(sizeof(struct cpu_stat) * MAX_CPU, GFP_KERNEL);
-    if (!g_cpu_stats)
+static int cpu_stat_ring_alloc(void) {
+    size_t slot_offset = ALIGN(sizeof(struct cpu_stat_ring_header), CPU_STAT_RING_ALIGN);
+    size_t slot_size = ALIGN(sizeof(struct cpu_stat_slot_header) +
+                             (size_t)nr_cpu_ids * sizeof(struct cpu_stat), CPU_STAT_RING_ALIGN);
+
+    g_ring_size = PAGE_ALIGN(slot_offset + slot_size * ring_slots);
+    g_ring = vmalloc_user(g_ring_size);
+    if (!g_ring)
         return -ENOMEM;
-    
-    // 初始化并启动定时器
-    ktime = ktime_set(0, UPDATE_INTERVAL_NS);
-    hrtimer_init(&cpu_stat_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+
+    g_header = g_ring;
+    g_header->version = CPU_STAT_RING_VERSION;
+    g_header->nr_cpus = nr_cpu_ids;
+    g_header->nr_slots = ring_slots;
+    g_header->slot_offset = slot_offset;
+    g_header->slot_size = slot_size;
+    g_header->stat_size = sizeof(struct cpu_stat);
+    g_header->period_ns = (u64)period_us * NSEC_PER_USEC;
+    g_header->magic = CPU_STAT_RING_MAGIC;
+    return 0;
+}
+
+static int __init cpu_stat_monitor_init(void) {
+    int ret;
+
+    if (period_us < MIN_PERIOD_US) {
+        pr_warn("cpu_stat_monitor: period_us %u too small, using %u\n", period_us, MIN_PERIOD_US);
+        period_us = MIN_PERIOD_US;
+    }
+    ring_slots = clamp_t(unsigned int, ring_slots, MIN_RING_SLOTS, MAX_RING_SLOTS);
+
+    ret = cpu_stat_ring_alloc();
+    if (ret)
+        return ret;
+
+    ret = misc_register(&cpu_stat_monitor_dev);
+    if (ret) {
+        vfree(g_ring);
+        return ret;
+    }
+
+    // 初始化并启动定时器；在软中断上下文中采样，避免 nr_cpu_ids 较大时长时间占用硬中断
+    ktime = ns_to_ktime(g_header->period_ns);
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 13, 0)
+    hrtimer_setup(&cpu_stat_timer, cpu_stat_timer_callback, CLOCK_MONOTONIC, HRTIMER_MODE_REL_SOFT);
+#else
+    hrtimer_init(&cpu_stat_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL_SOFT);
     cpu_stat_timer.function = &cpu_stat_timer_callback;
-    hrtimer_start(&cpu_stat_timer, ktime, HRTIMER_MODE_REL);
-    
-    misc_register(&cpu_stat_monitor_dev);
-    printk(KERN_INFO "cpu_stat_monitor device registered\n");
+#endif
+    hrtimer_start(&cpu_stat_timer, ktime, HRTIMER_MODE_REL_SOFT);
+
+    printk(KERN_INFO "cpu_stat_monitor device registered: %u cpus, %u slots, period %u us\n",
+           nr_cpu_ids, ring_slots, period_us);
     return 0;
 }
 
 static void __exit cpu_stat_monitor_exit(void) {
     hrtimer_cancel(&cpu_stat_timer);
     misc_deregister(&cpu_stat_monitor_dev);
-    if (g_cpu_stats)
-        kfree(g_cpu_stats); // 使用 kfree 替代 vfree
+    // 已建立的用户态映射持有页面引用，vfree 后映射仍然有效直到 munmap
+    if (g_ring)
+        vfree(g_ring);
     printk(KERN_INFO "cpu_stat_monitor device unregistered\n");
 }
 
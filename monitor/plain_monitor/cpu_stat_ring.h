@@ -0,0 +1,55 @@
+#ifndef CPU_STAT_RING_H
+#define CPU_STAT_RING_H
+
+// cpu_stat_monitor_kmod 通过 /dev/cpu_stat_monitor 映射给用户态的内存布局，内核与用户态共用
+//   cpu_stat_ring_header | slot 0 | slot 1 | ... | slot nr_slots-1
+// 每个 slot 是一次定时采样：cpu_stat_slot_header 后跟 nr_cpus 个 struct cpu_stat（按 CPU 编号）。
+// 内核是唯一的写端，第 g 代采样写入 slot (g % nr_slots)：
+//   slot.seq 变为奇数 -> 写入数据、generation、timestamp -> slot.seq 变为偶数 -> header.generation = g
+// 读端先读 header.generation 找到最新 slot，再按 seqlock 规则读取；
+// 读到的 slot.generation 与期望不一致说明该 slot 已被更新的采样覆盖。
+// 设备同时支持 read/poll：read 阻塞到有新一代采样后返回 8 字节的最新代数（__u64），
+// poll/epoll 在有未读的新一代采样时返回 EPOLLIN。
+
+#include <linux/types.h>
+
+#define CPU_STAT_RING_MAGIC 0x52535043u   // "CPSR"
+#define CPU_STAT_RING_VERSION 1
+#define CPU_STAT_RING_ALIGN 64
+
+struct cpu_stat {
+    __u32 online;       // 之后有4字节填充
+    __u64 user;
+    __u64 nice;
+    __u64 system;
+    __u64 idle;
+    __u64 io_wait;
+    __u64 irq;
+    __u64 soft_irq;
+    __u64 steal;
+    __u64 guest;
+    __u64 guest_nice;
+};
+
+struct cpu_stat_ring_header {
+    __u32 magic;
+    __u32 version;
+    __u32 nr_cpus;          // 每个 slot 中的 cpu_stat 个数（nr_cpu_ids）
+    __u32 nr_slots;         // 环形缓冲区的 slot 数
+    __u32 slot_offset;      // slot 0 相对映射起点的偏移
+    __u32 slot_size;        // 每个 slot 的字节数（按 CPU_STAT_RING_ALIGN 对齐）
+    __u32 stat_size;        // sizeof(struct cpu_stat)
+    __u32 reserved;
+    __u64 period_ns;        // 采样周期
+    __u64 generation;       // 最新一次完整发布的采样代数，0 表示还没有采样
+    __u64 missed;           // 定时器回调迟到而跳过的周期数
+};
+
+struct cpu_stat_slot_header {
+    __u64 seq;              // 奇数表示正在写入
+    __u64 generation;       // 该 slot 保存的采样代数
+    __u64 timestamp_ns;     // 采样时间（CLOCK_MONOTONIC）
+    __u64 reserved;
+};
+
+#endif // CPU_STAT_RING_H
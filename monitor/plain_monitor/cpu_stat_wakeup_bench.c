@@ -0,0 +1,114 @@
+// 基准测试：cpu_stat_monitor_kmod 发布采样到读者被唤醒的延迟
+// 读者阻塞在 read()（或 -p 时先 poll() 再 read()），醒来后用 CLOCK_MONOTONIC 减去该代 slot 的 timestamp_ns
+#include "cpu_stat_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define DEVICE_PATH "/dev/cpu_stat_monitor"
+#define DEFAULT_SAMPLES 1000
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static const struct cpu_stat_slot_header *ring_slot(const void *ring, uint64_t generation) {
+    const struct cpu_stat_ring_header *header = ring;
+    return (const void *)((const char *)ring + header->slot_offset +
+                          (size_t)(generation % header->nr_slots) * header->slot_size);
+}
+
+int main(int argc, char **argv) {
+    int samples = DEFAULT_SAMPLES, use_poll = 0, opt;
+
+    while ((opt = getopt(argc, argv, "n:p")) != -1) {
+        switch (opt) {
+        case 'n': samples = atoi(optarg); break;
+        case 'p': use_poll = 1; break;
+        default:
+            fprintf(stderr, "Usage: %s [-n samples] [-p]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (samples <= 0) samples = DEFAULT_SAMPLES;
+
+    int fd = open(DEVICE_PATH, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror("open " DEVICE_PATH);
+        return 1;
+    }
+
+    // 先映射一页读取头部，再按实际大小映射整个环
+    struct cpu_stat_ring_header *header = mmap(NULL, sizeof(*header), PROT_READ, MAP_SHARED, fd, 0);
+    if (header == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    if (header->magic != CPU_STAT_RING_MAGIC || header->stat_size != sizeof(struct cpu_stat)) {
+        fprintf(stderr, "unexpected ring layout: magic %#x stat_size %u\n", header->magic, header->stat_size);
+        return 1;
+    }
+    size_t ring_size = header->slot_offset + (size_t)header->slot_size * header->nr_slots;
+    uint64_t period_ns = header->period_ns;
+    munmap(header, sizeof(*header));
+
+    void *ring = mmap(NULL, ring_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (ring == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    uint64_t *latency = malloc((size_t)samples * sizeof(uint64_t));
+    uint64_t last_generation = 0, skipped = 0;
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+
+    for (int i = 0; i < samples; i++) {
+        uint64_t generation;
+
+        if (use_poll && poll(&pfd, 1, -1) < 0) {
+            perror("poll");
+            return 1;
+        }
+        if (read(fd, &generation, sizeof(generation)) != sizeof(generation)) {
+            perror("read");
+            return 1;
+        }
+        uint64_t woke = monotonic_ns();
+
+        // timestamp_ns 在 generation 发布前写入，slot 只有在落后 nr_slots 代时才会被覆盖
+        const struct cpu_stat_slot_header *slot = ring_slot(ring, generation);
+        latency[i] = woke - __atomic_load_n(&slot->timestamp_ns, __ATOMIC_ACQUIRE);
+        if (last_generation && generation > last_generation + 1) {
+            skipped += generation - last_generation - 1;
+        }
+        last_generation = generation;
+    }
+
+    qsort(latency, (size_t)samples, sizeof(uint64_t), compare_u64);
+    uint64_t sum = 0;
+    for (int i = 0; i < samples; i++) sum += latency[i];
+    printf("mode %s, period %.3f ms, %d wakeups, %lu generations skipped\n",
+           use_poll ? "poll+read" : "blocking read", period_ns / 1e6, samples, (unsigned long)skipped);
+    printf("publish->wakeup latency: mean %.1f us  p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+           sum / 1e3 / samples, latency[samples / 2] / 1e3,
+           latency[(size_t)(samples * 0.99)] / 1e3, latency[(size_t)(samples * 0.999)] / 1e3,
+           latency[samples - 1] / 1e3);
+
+    free(latency);
+    munmap(ring, ring_size);
+    close(fd);
+    return 0;
+}
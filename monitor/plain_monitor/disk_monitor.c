@@ -1,25 +1,28 @@
 #include "disk_monitor.h"
+#include "proc_parser.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/sysinfo.h>
 #include <ctype.h>
+#include <time.h>
 
-#define MAX_DISKS 64
 #define SECTOR_SIZE 512  // 通常扇区大小为512字节
 
+// /proc/diskstats 常驻句柄，避免每次采样都 fopen/fclose
+static ProcFile diskstats_file = PROC_FILE_INIT("/proc/diskstats");
+
 // 判断是否为ram/loop设备
 static int is_ram_or_loop_device(const char *disk_name) {
     return (strncmp(disk_name, "ram", 3) == 0) || 
            (strncmp(disk_name, "loop", 4) == 0);
 }
 
-// 解析一行diskstats数据
-static int parse_diskstats_line(const char *line, DiskStats *stats) {
-    int fields_parsed = sscanf(line, 
-        "%*d %*d %31s %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu",
-        stats->name,
+// 解析一行diskstats数据，line 指向行首
+static int parse_diskstats_line(const char *line, const char *end, DiskStats *stats) {
+    unsigned long major, minor;
+    unsigned long *fields[] = {
         &stats->reads_completed,
         &stats->reads_merged,
         &stats->sectors_read,
@@ -30,36 +33,53 @@ static int parse_diskstats_line(const char *line, DiskStats *stats) {
         &stats->time_writing_ms,
         &stats->ios_in_progress,
         &stats->time_io_ms,
-        &stats->weighted_time_io_ms);
-    
-    return (fields_parsed == 12);  // 应该解析出12个字段
+        &stats->weighted_time_io_ms,
+    };
+    const char *name;
+    size_t name_len;
+    const char *p = line;
+
+    if (!(p = proc_parse_ulong(p, end, &major))) return 0;
+    if (!(p = proc_parse_ulong(p, end, &minor))) return 0;
+    if (!(p = proc_parse_token(p, end, &name, &name_len))) return 0;
+
+    stats->major = (unsigned int)major;
+    stats->minor = (unsigned int)minor;
+    if (name_len >= sizeof(stats->name)) name_len = sizeof(stats->name) - 1;
+    memcpy(stats->name, name, name_len);
+    stats->name[name_len] = '\0';
+
+    // 新内核在后面还追加了discard/flush字段，这里只取前11个
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        if (!(p = proc_parse_ulong(p, end, fields[i]))) return 0;
+    }
+    return 1;
 }
 
 // 读取diskstats文件
 int get_diskstats(DiskStats *stats, int max_count) {
-    FILE *fp = fopen("/proc/diskstats", "r");
-    if (!fp) {
-        perror("Failed to open /proc/diskstats");
+    if (proc_file_read(&diskstats_file) < 0) {
         return -1;
     }
-    
-    char line[512];
+
+    const char *p = diskstats_file.buf;
+    const char *end = p + diskstats_file.len;
     int count = 0;
-    
-    while (fgets(line, sizeof(line), fp) && count < max_count) {
-        DiskStats disk;
-        memset(&disk, 0, sizeof(disk));
-        
-        if (parse_diskstats_line(line, &disk)) {
+
+    while (p < end && count < max_count) {
+        const char *next = proc_next_line(p, end);
+        DiskStats *disk = &stats[count];
+
+        memset(disk, 0, sizeof(*disk));
+        if (parse_diskstats_line(p, next, disk)) {
             // 过滤掉ram和loop设备
-            if (!is_ram_or_loop_device(disk.name)) {
-                stats[count] = disk;
+            if (!is_ram_or_loop_device(disk->name)) {
                 count++;
             }
         }
+        p = next;
     }
-    
-    fclose(fp);
+
     return count;
 }
 
@@ -97,4 +117,207 @@ void calculate_disk_metrics(DiskStats *current, const DiskStats *previous, doubl
     unsigned long io_time_delta = current->weighted_time_io_ms - previous->weighted_time_io_ms;
     current->utilization = (io_time_delta / 10.0) / time_interval_sec;
     if (current->utilization > 100.0) current->utilization = 100.0;
-}
\ No newline at end of file
+}
+
+// ---- 设备注册表 ----
+
+#define INDEX_EMPTY (-1)
+#define INDEX_TOMBSTONE (-2)
+#define INDEX_INITIAL_CAPACITY 64
+#define DEVICE_INITIAL_CAPACITY 32
+
+static inline size_t device_hash(unsigned int major, unsigned int minor, size_t mask) {
+    uint64_t key = ((uint64_t)major << 32) | minor;
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+static int *index_alloc(size_t capacity) {
+    int *index = malloc(capacity * sizeof(int));
+    if (!index) return NULL;
+    for (size_t i = 0; i < capacity; i++) index[i] = INDEX_EMPTY;
+    return index;
+}
+
+// 重建哈希表（清除墓碑，必要时扩容）
+static int index_rebuild(DiskRegistry *reg, size_t capacity) {
+    int *index = index_alloc(capacity);
+    if (!index) return -1;
+
+    size_t mask = capacity - 1;
+    for (int slot = 0; slot < reg->device_high; slot++) {
+        const DiskDevice *dev = &reg->devices[slot];
+        if (!dev->in_use) continue;
+        size_t pos = device_hash(dev->current.major, dev->current.minor, mask);
+        while (index[pos] != INDEX_EMPTY) pos = (pos + 1) & mask;
+        index[pos] = slot;
+    }
+
+    free(reg->index);
+    reg->index = index;
+    reg->index_capacity = capacity;
+    reg->index_used = (size_t)reg->device_count;
+    return 0;
+}
+
+// 分配一个空闲槽位，优先复用已移除设备的槽位
+static int device_slot_alloc(DiskRegistry *reg) {
+    if (reg->free_head >= 0) {
+        int slot = reg->free_head;
+        reg->free_head = reg->devices[slot].next_free;
+        return slot;
+    }
+    if (reg->device_high == reg->device_capacity) {
+        int new_capacity = reg->device_capacity * 2;
+        DiskDevice *devices = realloc(reg->devices, (size_t)new_capacity * sizeof(DiskDevice));
+        if (!devices) return -1;
+        reg->devices = devices;
+        reg->device_capacity = new_capacity;
+    }
+    return reg->device_high++;
+}
+
+// 查找设备槽位，不存在时新建，失败返回-1
+static int device_lookup_or_insert(DiskRegistry *reg, unsigned int major, unsigned int minor) {
+    // 负载因子（含墓碑）保持在1/2以下
+    if ((reg->index_used + 1) * 2 > reg->index_capacity) {
+        size_t capacity = reg->index_capacity;
+        if (((size_t)reg->device_count + 1) * 4 > capacity) capacity *= 2;
+        if (index_rebuild(reg, capacity) != 0) return -1;
+    }
+
+    size_t mask = reg->index_capacity - 1;
+    size_t pos = device_hash(major, minor, mask);
+    size_t insert_pos = (size_t)-1;
+
+    while (reg->index[pos] != INDEX_EMPTY) {
+        int slot = reg->index[pos];
+        if (slot == INDEX_TOMBSTONE) {
+            if (insert_pos == (size_t)-1) insert_pos = pos;
+        } else if (reg->devices[slot].current.major == major &&
+                   reg->devices[slot].current.minor == minor) {
+            return slot;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    int slot = device_slot_alloc(reg);
+    if (slot < 0) return -1;
+
+    if (insert_pos == (size_t)-1) {
+        insert_pos = pos;
+        reg->index_used++;
+    }
+    reg->index[insert_pos] = slot;
+    reg->device_count++;
+
+    DiskDevice *dev = &reg->devices[slot];
+    memset(dev, 0, sizeof(*dev));
+    dev->in_use = 1;
+    dev->next_free = -1;
+    dev->current.major = major;
+    dev->current.minor = minor;
+    return slot;
+}
+
+// 移除设备：哈希表项置为墓碑，槽位放回空闲链表
+static void device_remove(DiskRegistry *reg, int slot) {
+    DiskDevice *dev = &reg->devices[slot];
+    size_t mask = reg->index_capacity - 1;
+    size_t pos = device_hash(dev->current.major, dev->current.minor, mask);
+
+    while (reg->index[pos] != slot) pos = (pos + 1) & mask;
+    reg->index[pos] = INDEX_TOMBSTONE;
+
+    dev->in_use = 0;
+    dev->next_free = reg->free_head;
+    reg->free_head = slot;
+    reg->device_count--;
+}
+
+int disk_registry_init(DiskRegistry *reg) {
+    memset(reg, 0, sizeof(*reg));
+    reg->free_head = -1;
+    reg->devices = malloc(DEVICE_INITIAL_CAPACITY * sizeof(DiskDevice));
+    reg->index = index_alloc(INDEX_INITIAL_CAPACITY);
+    if (!reg->devices || !reg->index) {
+        disk_registry_free(reg);
+        return -1;
+    }
+    reg->device_capacity = DEVICE_INITIAL_CAPACITY;
+    reg->index_capacity = INDEX_INITIAL_CAPACITY;
+    return 0;
+}
+
+void disk_registry_free(DiskRegistry *reg) {
+    free(reg->devices);
+    free(reg->index);
+    memset(reg, 0, sizeof(*reg));
+    reg->free_head = -1;
+}
+
+int disk_registry_ingest(DiskRegistry *reg, const char *buf, size_t len) {
+    const char *p = buf;
+    const char *end = buf + len;
+    unsigned long generation = ++reg->generation;
+    DiskStats disk;
+
+    while (p < end) {
+        const char *next = proc_next_line(p, end);
+
+        memset(&disk, 0, sizeof(disk));
+        if (parse_diskstats_line(p, next, &disk) && !is_ram_or_loop_device(disk.name)) {
+            int slot = device_lookup_or_insert(reg, disk.major, disk.minor);
+            if (slot < 0) return -1;
+
+            DiskDevice *dev = &reg->devices[slot];
+            // 同一 major:minor 在两次采样之间被另一个设备复用时，不与旧设备配对
+            dev->has_previous = dev->generation != 0 && dev->generation == generation - 1 &&
+                                strcmp(dev->current.name, disk.name) == 0;
+            dev->previous = dev->current;
+            dev->current = disk;
+            dev->generation = generation;
+        }
+        p = next;
+    }
+
+    // 本次未出现的设备已被移除
+    for (int slot = 0; slot < reg->device_high; slot++) {
+        DiskDevice *dev = &reg->devices[slot];
+        if (dev->in_use && dev->generation != generation) {
+            device_remove(reg, slot);
+        }
+    }
+
+    return reg->device_count;
+}
+
+void disk_registry_calculate(DiskRegistry *reg, double time_interval_sec) {
+    for (int slot = 0; slot < reg->device_high; slot++) {
+        DiskDevice *dev = &reg->devices[slot];
+        if (!dev->in_use || !dev->has_previous) continue;
+        calculate_disk_metrics(&dev->current, &dev->previous, time_interval_sec);
+    }
+}
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int disk_registry_update(DiskRegistry *reg) {
+    if (proc_file_read(&diskstats_file) < 0) {
+        return -1;
+    }
+
+    double now = monotonic_seconds();
+    int count = disk_registry_ingest(reg, diskstats_file.buf, diskstats_file.len);
+    if (count < 0) return -1;
+
+    // 按实际采样间隔计算，调度抖动不会影响速率
+    if (reg->sample_time > 0) {
+        disk_registry_calculate(reg, now - reg->sample_time);
+    }
+    reg->sample_time = now;
+    return count;
+}
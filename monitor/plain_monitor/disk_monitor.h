@@ -2,10 +2,13 @@
 #define DISK_MONITOR_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 // 磁盘统计数据结构
 typedef struct {
     char name[32];          // 磁盘名称
+    unsigned int major;     // 主设备号
+    unsigned int minor;     // 次设备号
     unsigned long reads_completed;      // 读完成次数
     unsigned long reads_merged;         // 读合并次数  
     unsigned long sectors_read;         // 读扇区数
@@ -30,10 +33,50 @@ typedef struct {
     double utilization;           // 磁盘利用率(%)
 } DiskStats;
 
+// 设备注册表中的一个槽位，设备存活期间槽位下标保持不变
+typedef struct {
+    int in_use;                 // 槽位是否被设备占用
+    int has_previous;           // previous 是否为同一设备的上一次采样
+    int next_free;              // 空闲链表中的下一个槽位（-1 结束）
+    unsigned long generation;   // 设备最近一次出现时的采样代数
+    DiskStats current;          // 本次采样（含计算出的指标）
+    DiskStats previous;         // 上一次采样
+} DiskDevice;
+
+// 以 (major, minor) 为键的设备注册表，容量按需增长
+// 设备热插拔时只影响自身槽位，其余设备仍与自己的上一次采样配对
+typedef struct {
+    DiskDevice *devices;        // 槽位数组
+    int device_capacity;        // 槽位数组容量
+    int device_high;            // 已使用过的最大槽位下标+1，遍历上界
+    int device_count;           // 当前存活设备数
+    int free_head;              // 空闲槽位链表头（-1 表示无）
+
+    int *index;                 // 开放寻址哈希表：槽位下标，INDEX_EMPTY/INDEX_TOMBSTONE 为特殊值
+    size_t index_capacity;      // 哈希表容量（2的幂）
+    size_t index_used;          // 已占用的哈希表项（含墓碑）
+
+    unsigned long generation;   // 采样代数，每次 ingest 加1
+    double sample_time;         // 最近一次采样的单调时钟时间(秒)
+} DiskRegistry;
+
 // 获取磁盘统计信息的接口
 int get_diskstats(DiskStats *stats, int max_count);
 
 // 计算磁盘性能指标的接口
 void calculate_disk_metrics(DiskStats *current, const DiskStats *previous, double time_interval_sec);
 
+// 初始化/释放设备注册表
+int disk_registry_init(DiskRegistry *reg);
+void disk_registry_free(DiskRegistry *reg);
+
+// 读取 /proc/diskstats，更新注册表并按实际采样间隔计算指标，返回当前设备数，失败返回-1
+int disk_registry_update(DiskRegistry *reg);
+
+// 用已读入内存的 diskstats 内容更新注册表（不计算指标），返回当前设备数，失败返回-1
+int disk_registry_ingest(DiskRegistry *reg, const char *buf, size_t len);
+
+// 单次遍历注册表，为所有有上一次采样的设备计算指标
+void disk_registry_calculate(DiskRegistry *reg, double time_interval_sec);
+
 #endif // DISK_MONITOR_H
\ No newline at end of file
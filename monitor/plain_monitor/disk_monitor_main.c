@@ -4,11 +4,8 @@
 #include <unistd.h>
 #include <time.h>
 
-#define MAX_DISKS 64
-
 int main() {
-    DiskStats current[MAX_DISKS];
-    DiskStats previous[MAX_DISKS];
+    DiskRegistry registry;
     int disk_count;
     double interval_sec = 2.0; // 2秒间隔
 
@@ -16,54 +13,52 @@ int main() {
     printf("按Ctrl+C停止\n");
     printf("================================\n");
 
+    if (disk_registry_init(&registry) != 0) {
+        fprintf(stderr, "无法初始化磁盘注册表\n");
+        return 1;
+    }
+
     // 获取初始状态
-    disk_count = get_diskstats(current, MAX_DISKS);
+    disk_count = disk_registry_update(&registry);
     if (disk_count <= 0) {
         fprintf(stderr, "无法获取磁盘统计信息\n");
+        disk_registry_free(&registry);
         return 1;
     }
-    
-    // 保存初始状态为上一次状态
-    memcpy(previous, current, disk_count * sizeof(DiskStats));
 
     while (1) {
         sleep(interval_sec);
         
-        // 获取当前状态
-        disk_count = get_diskstats(current, MAX_DISKS);
+        // 获取当前状态并计算指标（设备按 major:minor 与自己的上一次采样配对）
+        disk_count = disk_registry_update(&registry);
         if (disk_count <= 0) {
             fprintf(stderr, "无法获取磁盘统计信息\n");
             continue;
         }
         
-        // 计算指标
-        for (int i = 0; i < disk_count; i++) {
-            calculate_disk_metrics(&current[i], &previous[i], interval_sec);
-        }
-        
         // 打印结果
-        printf("\n=== 磁盘性能统计 (%.1f秒) ===\n", interval_sec);
+        printf("\n=== 磁盘性能统计 (%.1f秒, %d个设备) ===\n", interval_sec, disk_count);
         printf("%-8s %8s %8s %8s %8s %8s %8s %8s\n", 
                "设备", "读吞吐", "写吞吐", "总吞吐", "读IOPS", "写IOPS", "读时延", "写时延");
         printf("%-8s %8s %8s %8s %8s %8s %8s %8s\n", 
                "", "(MB/s)", "(MB/s)", "(MB/s)", "(ops/s)", "(ops/s)", "(ms)", "(ms)");
         printf("------------------------------------------------------------------------\n");
         
-        for (int i = 0; i < disk_count; i++) {
+        for (int i = 0; i < registry.device_high; i++) {
+            const DiskDevice *dev = &registry.devices[i];
+            if (!dev->in_use) continue;
             printf("%-8s %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f\n",
-                   current[i].name,
-                   current[i].read_throughput_mb,
-                   current[i].write_throughput_mb, 
-                   current[i].total_throughput_mb,
-                   current[i].read_iops,
-                   current[i].write_iops,
-                   current[i].avg_read_latency_ms,
-                   current[i].avg_write_latency_ms);
+                   dev->current.name,
+                   dev->current.read_throughput_mb,
+                   dev->current.write_throughput_mb, 
+                   dev->current.total_throughput_mb,
+                   dev->current.read_iops,
+                   dev->current.write_iops,
+                   dev->current.avg_read_latency_ms,
+                   dev->current.avg_write_latency_ms);
         }
-        
-        // 更新上一次状态
-        memcpy(previous, current, disk_count * sizeof(DiskStats));
     }
     
+    disk_registry_free(&registry);
     return 0;
-}
\ No newline at end of file
+}
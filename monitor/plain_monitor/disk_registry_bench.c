@@ -0,0 +1,107 @@
+// 基准测试：4096个合成设备下设备注册表的 ingest 与单次 calculate 遍历开销，
+// 并校验热插拔后其余设备仍与自己的上一次采样配对
+#include "disk_monitor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_DEVICES 4096
+#define HOTPLUG_COUNT 256
+#define INTERVAL_SEC 1.0
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// 设备 i 每个采样周期完成 (i % 100 + 1) 次读
+static unsigned long reads_per_tick(unsigned int id) {
+    return id % 100 + 1;
+}
+
+// 生成一份合成 diskstats：设备编号 [first, first + count)，跳过 [skip_from, skip_to)
+static size_t build_diskstats(char *buf, size_t cap, unsigned int first, unsigned int count,
+                              unsigned int skip_from, unsigned int skip_to, unsigned long tick) {
+    size_t len = 0;
+    for (unsigned int id = first; id < first + count; id++) {
+        if (id >= skip_from && id < skip_to) continue;
+        unsigned long reads = reads_per_tick(id) * tick;
+        int n = snprintf(buf + len, cap - len,
+                         "%4u %7u nvme%un%u %lu 0 %lu %lu %lu 0 %lu %lu 0 %lu %lu 0 0 0 0 0 0\n",
+                         259 + id / 1024, id % 1024, id / 64, id % 64 + 1,
+                         reads, reads * 8, reads, reads, reads * 8, reads, tick * 10, tick * 10);
+        if (n < 0 || (size_t)n >= cap - len) break;
+        len += (size_t)n;
+    }
+    return len;
+}
+
+// 校验所有有上一次采样的设备速率
+static int verify(const DiskRegistry *reg) {
+    int errors = 0;
+    for (int i = 0; i < reg->device_high; i++) {
+        const DiskDevice *dev = &reg->devices[i];
+        if (!dev->in_use || !dev->has_previous) continue;
+        unsigned int id = (dev->current.major - 259) * 1024 + dev->current.minor;
+        double expected = reads_per_tick(id) / INTERVAL_SEC;
+        if (dev->current.read_iops != expected) errors++;
+    }
+    return errors;
+}
+
+int main(int argc, char **argv) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 2000;
+    size_t cap = (size_t)BENCH_DEVICES * 160;
+    char *sample[2] = { malloc(cap), malloc(cap) };
+    size_t sample_len[2];
+    DiskRegistry reg;
+
+    if (iterations <= 0) iterations = 2000;
+    if (!sample[0] || !sample[1] || disk_registry_init(&reg) != 0) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+
+    // 1. ingest 开销：两份样本交替输入
+    sample_len[0] = build_diskstats(sample[0], cap, 0, BENCH_DEVICES, 0, 0, 1);
+    sample_len[1] = build_diskstats(sample[1], cap, 0, BENCH_DEVICES, 0, 0, 2);
+    disk_registry_ingest(&reg, sample[0], sample_len[0]);
+
+    double start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        disk_registry_ingest(&reg, sample[(i + 1) & 1], sample_len[(i + 1) & 1]);
+    }
+    double ingest_ns = (now_ns() - start) / iterations;
+
+    // 2. calculate 单次遍历开销
+    start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        disk_registry_calculate(&reg, INTERVAL_SEC);
+    }
+    double calc_ns = (now_ns() - start) / iterations;
+
+    printf("devices: %d, iterations: %d\n", reg.device_count, iterations);
+    printf("ingest:    %10.0f ns/sample %8.1f ns/device\n", ingest_ns, ingest_ns / reg.device_count);
+    printf("calculate: %10.0f ns/pass   %8.1f ns/device\n", calc_ns, calc_ns / reg.device_count);
+
+    // 3. 热插拔：移除中间一段设备并在末尾新增同样数量的设备
+    disk_registry_free(&reg);
+    disk_registry_init(&reg);
+    sample_len[0] = build_diskstats(sample[0], cap, 0, BENCH_DEVICES, 0, 0, 1);
+    sample_len[1] = build_diskstats(sample[1], cap, 0, BENCH_DEVICES + HOTPLUG_COUNT,
+                                    1000, 1000 + HOTPLUG_COUNT, 2);
+    disk_registry_ingest(&reg, sample[0], sample_len[0]);
+    disk_registry_ingest(&reg, sample[1], sample_len[1]);
+    disk_registry_calculate(&reg, INTERVAL_SEC);
+
+    int errors = verify(&reg);
+    printf("hotplug:   %d devices after removing/adding %d, mismatched rates: %d\n",
+           reg.device_count, HOTPLUG_COUNT, errors);
+
+    disk_registry_free(&reg);
+    free(sample[0]);
+    free(sample[1]);
+    return errors ? 1 : 0;
+}
@@ -1,55 +1,308 @@
 #include "mem_monitor.h"
+#include "proc_parser.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <ctype.h>
 
-// 修正后的解析函数（静态内部函数）
-static void parse_meminfo_line(const char *line, MemInfo *info) {
-    char key[32];
+// /proc/meminfo 常驻句柄，避免每次采样都 fopen/fclose
+static ProcFile meminfo_file = PROC_FILE_INIT("/proc/meminfo");
+
+#define MEMINFO_KEY(literal, field) \
+    if (memcmp(key, literal, sizeof(literal) - 1) == 0) return (long)offsetof(MemInfo, field)
+
+// 由key查找 MemInfo 中对应字段的偏移，未知key返回-1
+// 分支按 key长度 -> 组内可区分的单个字符 展开，最后用定长 memcmp 确认，
+// 定长比较会被编译器内联成几次整数比较，每行只需要一到两次比较即可定位字段。
+// 以下 switch 与 MemInfo 的字段一一对应：新增字段时放入对应长度分组，
+// 若分组内出现区分字符冲突，换用组内各key互不相同的字符位置。
+static long meminfo_field_offset(const char *key, size_t len) {
+    switch (len) {
+    case 4:
+        MEMINFO_KEY("Slab", slab);
+        break;
+    case 5:
+        switch (key[0]) {
+        case 'Z':
+            MEMINFO_KEY("Zswap", zswap);
+            break;
+        case 'D':
+            MEMINFO_KEY("Dirty", dirty);
+            break;
+        case 'S':
+            MEMINFO_KEY("Shmem", shmem);
+            break;
+        }
+        break;
+    case 6:
+        switch (key[0]) {
+        case 'C':
+            MEMINFO_KEY("Cached", cached);
+            break;
+        case 'A':
+            MEMINFO_KEY("Active", active);
+            break;
+        case 'M':
+            MEMINFO_KEY("Mapped", mapped);
+            break;
+        case 'B':
+            MEMINFO_KEY("Bounce", bounce);
+            break;
+        case 'P':
+            MEMINFO_KEY("Percpu", percpu);
+            break;
+        }
+        break;
+    case 7:
+        switch (key[2]) {
+        case 'm':
+            MEMINFO_KEY("MemFree", mem_free);
+            break;
+        case 'f':
+            MEMINFO_KEY("Buffers", buffers);
+            break;
+        case 'o':
+            MEMINFO_KEY("Mlocked", mlocked);
+            break;
+        case 'w':
+            MEMINFO_KEY("LowFree", low_free);
+            break;
+        case 'a':
+            MEMINFO_KEY("CmaFree", cma_free);
+            break;
+        case 'l':
+            MEMINFO_KEY("Balloon", balloon);
+            break;
+        case 'g':
+            MEMINFO_KEY("Hugetlb", hugetlb);
+            break;
+        }
+        break;
+    case 8:
+        switch (key[0]) {
+        case 'M':
+            MEMINFO_KEY("MemTotal", mem_total);
+            MEMINFO_KEY("MmapCopy", mmap_copy);
+            break;
+        case 'I':
+            MEMINFO_KEY("Inactive", inactive);
+            break;
+        case 'H':
+            MEMINFO_KEY("HighFree", high_free);
+            break;
+        case 'L':
+            MEMINFO_KEY("LowTotal", low_total);
+            break;
+        case 'S':
+            MEMINFO_KEY("SwapFree", swap_free);
+            break;
+        case 'Z':
+            MEMINFO_KEY("Zswapped", zswapped);
+            break;
+        case 'C':
+            MEMINFO_KEY("CmaTotal", cma_total);
+            break;
+        }
+        break;
+    case 9:
+        switch (key[0]) {
+        case 'H':
+            MEMINFO_KEY("HighTotal", high_total);
+            break;
+        case 'S':
+            MEMINFO_KEY("SwapTotal", swap_total);
+            break;
+        case 'W':
+            MEMINFO_KEY("Writeback", writeback);
+            break;
+        case 'A':
+            MEMINFO_KEY("AnonPages", anon_pages);
+            break;
+        }
+        break;
+    case 10:
+        switch (key[1]) {
+        case 'w':
+            MEMINFO_KEY("SwapCached", swap_cached);
+            break;
+        case 'U':
+            MEMINFO_KEY("SUnreclaim", sunreclaim);
+            break;
+        case 'a':
+            MEMINFO_KEY("PageTables", page_tables);
+            break;
+        case 'n':
+            MEMINFO_KEY("Unaccepted", unaccepted);
+            break;
+        }
+        break;
+    case 11:
+        switch (key[9]) {
+        case 'l':
+            MEMINFO_KEY("Unevictable", unevictable);
+            break;
+        case 'c':
+            MEMINFO_KEY("KernelStack", kernel_stack);
+            break;
+        case 'i':
+            MEMINFO_KEY("CommitLimit", commit_limit);
+            break;
+        case 'e':
+            MEMINFO_KEY("VmallocUsed", vmalloc_used);
+            break;
+        case '4':
+            MEMINFO_KEY("DirectMap4k", direct_map_4k);
+            MEMINFO_KEY("DirectMap4M", direct_map_4m);
+            break;
+        case '2':
+            MEMINFO_KEY("DirectMap2M", direct_map_2m);
+            break;
+        case '1':
+            MEMINFO_KEY("DirectMap1G", direct_map_1g);
+            break;
+        }
+        break;
+    case 12:
+        switch (key[0]) {
+        case 'M':
+            MEMINFO_KEY("MemAvailable", mem_available);
+            break;
+        case 'A':
+            MEMINFO_KEY("Active(anon)", active_anon);
+            MEMINFO_KEY("Active(file)", active_file);
+            break;
+        case 'K':
+            MEMINFO_KEY("KReclaimable", kreclaimable);
+            break;
+        case 'S':
+            MEMINFO_KEY("SReclaimable", sreclaimable);
+            break;
+        case 'N':
+            MEMINFO_KEY("NFS_Unstable", nfs_unstable);
+            break;
+        case 'W':
+            MEMINFO_KEY("WritebackTmp", writeback_tmp);
+            break;
+        case 'C':
+            MEMINFO_KEY("Committed_AS", committed_as);
+            break;
+        case 'V':
+            MEMINFO_KEY("VmallocTotal", vmalloc_total);
+            MEMINFO_KEY("VmallocChunk", vmalloc_chunk);
+            break;
+        case 'H':
+            MEMINFO_KEY("Hugepagesize", hugepagesize);
+            break;
+        }
+        break;
+    case 13:
+        switch (key[0]) {
+        case 'S':
+            MEMINFO_KEY("SecPageTables", sec_page_tables);
+            break;
+        case 'A':
+            MEMINFO_KEY("AnonHugePages", anon_huge_pages);
+            break;
+        case 'F':
+            MEMINFO_KEY("FileHugePages", file_huge_pages);
+            MEMINFO_KEY("FilePmdMapped", file_pmd_mapped);
+            break;
+        }
+        break;
+    case 14:
+        switch (key[10]) {
+        case 'n':
+            MEMINFO_KEY("Inactive(anon)", inactive_anon);
+            break;
+        case 'i':
+            MEMINFO_KEY("Inactive(file)", inactive_file);
+            break;
+        case 'a':
+            MEMINFO_KEY("ShmemHugePages", shmem_huge_pages);
+            break;
+        case 'p':
+            MEMINFO_KEY("ShmemPmdMapped", shmem_pmd_mapped);
+            break;
+        case 'F':
+            MEMINFO_KEY("HugePages_Free", huge_pages_free);
+            break;
+        case 'R':
+            MEMINFO_KEY("HugePages_Rsvd", huge_pages_rsvd);
+            break;
+        case 'S':
+            MEMINFO_KEY("HugePages_Surp", huge_pages_surp);
+            break;
+        }
+        break;
+    case 15:
+        switch (key[0]) {
+        case 'S':
+            MEMINFO_KEY("ShadowCallStack", shadow_call_stack);
+            break;
+        case 'H':
+            MEMINFO_KEY("HugePages_Total", huge_pages_total);
+            break;
+        }
+        break;
+    case 17:
+        MEMINFO_KEY("HardwareCorrupted", hardware_corrupted);
+        break;
+    }
+    return -1;
+}
+
+// 解析一行 "Key:   value kB"，line 指向行首
+static void parse_meminfo_line(const char *line, const char *end, MemInfo *info) {
+    const char *colon = memchr(line, ':', (size_t)(end - line));
     unsigned long value;
-    const char *colon = strchr(line, ':');
-    
+
     if (!colon) return;  // 没有冒号，跳过
-    
-    // 提取key（冒号前的部分）
-    size_t key_len = colon - line;
-    if (key_len >= sizeof(key)) return;
-    strncpy(key, line, key_len);
-    key[key_len] = '\0';
-    
-    // 跳过冒号和后续空白
-    char *value_str = colon + 1;
-    while (*value_str && isspace(*value_str)) value_str++;
-    
-    // 提取数字
-    if (sscanf(value_str, "%lu", &value) == 1) {
-        if (strcmp(key, "MemTotal") == 0) info->mem_total = value;
-        else if (strcmp(key, "MemFree") == 0) info->mem_free = value;
-        else if (strcmp(key, "MemAvailable") == 0) info->mem_available = value;
-        else if (strcmp(key, "Buffers") == 0) info->buffers = value;
-        else if (strcmp(key, "Cached") == 0) info->cached = value;
-        else if (strcmp(key, "SwapTotal") == 0) info->swap_total = value;
-        else if (strcmp(key, "SwapFree") == 0) info->swap_free = value;
+
+    long offset = meminfo_field_offset(line, (size_t)(colon - line));
+    if (offset < 0) return;  // 不关心或当前版本未收录的字段
+
+    // 提取数字，直接写入字段偏移处
+    if (proc_parse_ulong(colon + 1, end, &value)) {
+        *(unsigned long *)((char *)info + offset) = value;
+    }
+}
+
+void parse_meminfo(const char *buf, size_t len, MemInfo *info) {
+    const char *p = buf;
+    const char *end = buf + len;
+
+    memset(info, 0, sizeof(MemInfo));  // 初始化为0
+    while (p < end) {
+        const char *next = proc_next_line(p, end);
+        parse_meminfo_line(p, next, info);
+        p = next;
+    }
+}
+
+void parse_node_meminfo(const char *buf, size_t len, MemInfo *info) {
+    const char *p = buf;
+    const char *end = buf + len;
+    unsigned long node;
+
+    memset(info, 0, sizeof(MemInfo));
+    while (p < end) {
+        const char *next = proc_next_line(p, end);
+        // 跳过行首的 "Node <n>"，其余部分与 /proc/meminfo 的行格式相同
+        if (next - p > 5 && memcmp(p, "Node ", 5) == 0) {
+            const char *key = proc_parse_ulong(p + 5, next, &node);
+            if (key) parse_meminfo_line(proc_skip_spaces(key, next), next, info);
+        }
+        p = next;
     }
 }
 
 // 从/proc/meminfo读取并解析内存信息
 int get_meminfo(MemInfo *info) {
-    FILE *fp = fopen("/proc/meminfo", "r");
-    if (!fp) {
-        perror("Failed to open /proc/meminfo");
+    if (proc_file_read(&meminfo_file) < 0) {
         return -1;
     }
 
-    char line[256];
-    memset(info, 0, sizeof(MemInfo));  // 初始化为0
-    
-    while (fgets(line, sizeof(line), fp)) {
-        parse_meminfo_line(line, info);
-    }
-    
-    fclose(fp);
+    parse_meminfo(meminfo_file.buf, meminfo_file.len, info);
     return 0;
-}
\ No newline at end of file
+}
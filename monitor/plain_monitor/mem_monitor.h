@@ -2,8 +2,10 @@
 #define MEM_MONITOR_H
 
 #include <stdint.h>
+#include <stddef.h>
 
-// 内存信息数据结构
+// 内存信息数据结构，覆盖 /proc/meminfo 的全部字段（单位与文件一致：大多为kB，HugePages_*为页数）
+// 当前内核不提供的字段保持为0
 typedef struct {
     unsigned long mem_total;       // MemTotal
     unsigned long mem_free;        // MemFree
@@ -12,9 +14,96 @@ typedef struct {
     unsigned long cached;          // Cached
     unsigned long swap_total;      // SwapTotal
     unsigned long swap_free;       // SwapFree
+
+    // LRU链表
+    unsigned long swap_cached;     // SwapCached
+    unsigned long active;          // Active
+    unsigned long inactive;        // Inactive
+    unsigned long active_anon;     // Active(anon)
+    unsigned long inactive_anon;   // Inactive(anon)
+    unsigned long active_file;     // Active(file)
+    unsigned long inactive_file;   // Inactive(file)
+    unsigned long unevictable;     // Unevictable
+    unsigned long mlocked;         // Mlocked
+
+    // 32位高/低端内存与nommu
+    unsigned long high_total;      // HighTotal
+    unsigned long high_free;       // HighFree
+    unsigned long low_total;       // LowTotal
+    unsigned long low_free;        // LowFree
+    unsigned long mmap_copy;       // MmapCopy
+
+    // zswap
+    unsigned long zswap;           // Zswap
+    unsigned long zswapped;        // Zswapped
+
+    // 页缓存与匿名页
+    unsigned long dirty;           // Dirty
+    unsigned long writeback;       // Writeback
+    unsigned long anon_pages;      // AnonPages
+    unsigned long mapped;          // Mapped
+    unsigned long shmem;           // Shmem
+
+    // 内核内存
+    unsigned long kreclaimable;    // KReclaimable
+    unsigned long slab;            // Slab
+    unsigned long sreclaimable;    // SReclaimable
+    unsigned long sunreclaim;      // SUnreclaim
+    unsigned long kernel_stack;    // KernelStack
+    unsigned long shadow_call_stack; // ShadowCallStack
+    unsigned long page_tables;     // PageTables
+    unsigned long sec_page_tables; // SecPageTables
+    unsigned long nfs_unstable;    // NFS_Unstable
+    unsigned long bounce;          // Bounce
+    unsigned long writeback_tmp;   // WritebackTmp
+
+    // 内存承诺
+    unsigned long commit_limit;    // CommitLimit
+    unsigned long committed_as;    // Committed_AS
+
+    // vmalloc与per-cpu
+    unsigned long vmalloc_total;   // VmallocTotal
+    unsigned long vmalloc_used;    // VmallocUsed
+    unsigned long vmalloc_chunk;   // VmallocChunk
+    unsigned long percpu;          // Percpu
+    unsigned long hardware_corrupted; // HardwareCorrupted
+
+    // 透明大页
+    unsigned long anon_huge_pages; // AnonHugePages
+    unsigned long shmem_huge_pages; // ShmemHugePages
+    unsigned long shmem_pmd_mapped; // ShmemPmdMapped
+    unsigned long file_huge_pages; // FileHugePages
+    unsigned long file_pmd_mapped; // FilePmdMapped
+
+    // CMA、未接受内存与气球驱动
+    unsigned long cma_total;       // CmaTotal
+    unsigned long cma_free;        // CmaFree
+    unsigned long unaccepted;      // Unaccepted
+    unsigned long balloon;         // Balloon
+
+    // hugetlbfs
+    unsigned long huge_pages_total; // HugePages_Total
+    unsigned long huge_pages_free; // HugePages_Free
+    unsigned long huge_pages_rsvd; // HugePages_Rsvd
+    unsigned long huge_pages_surp; // HugePages_Surp
+    unsigned long hugepagesize;    // Hugepagesize
+    unsigned long hugetlb;         // Hugetlb
+
+    // 直接映射区
+    unsigned long direct_map_4k;   // DirectMap4k
+    unsigned long direct_map_2m;   // DirectMap2M
+    unsigned long direct_map_4m;   // DirectMap4M
+    unsigned long direct_map_1g;   // DirectMap1G
 } MemInfo;
 
 // 获取内存信息的接口
 int get_meminfo(MemInfo *info);
 
-#endif // MEM_MONITOR_H
\ No newline at end of file
+// 从已读入内存的 /proc/meminfo 内容解析内存信息
+void parse_meminfo(const char *buf, size_t len, MemInfo *info);
+
+// 解析 /sys/devices/system/node/node<n>/meminfo（每行带 "Node <n> " 前缀），
+// 节点文件中没有的字段（如 MemAvailable、Cached）保持为0
+void parse_node_meminfo(const char *buf, size_t len, MemInfo *info);
+
+#endif // MEM_MONITOR_H
@@ -26,6 +26,12 @@ int main() {
                 printf("  Cached:       %8lu kB\n", info.cached);
                 printf("  Swap Total:   %8lu kB\n", info.swap_total);
                 printf("  Swap Free:    %8lu kB\n", info.swap_free);
+                printf("  Dirty:        %8lu kB\n", info.dirty);
+                printf("  Writeback:    %8lu kB\n", info.writeback);
+                printf("  AnonPages:    %8lu kB\n", info.anon_pages);
+                printf("  Slab:         %8lu kB\n", info.slab);
+                printf("  Committed_AS: %8lu kB\n", info.committed_as);
+                printf("  HugePages:    %8lu/%lu\n", info.huge_pages_free, info.huge_pages_total);
             } else {
                 fprintf(stderr, "Failed to get memory info\n");
             }
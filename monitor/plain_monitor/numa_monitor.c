@@ -0,0 +1,143 @@
+#include "numa_monitor.h"
+#include "mem_monitor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#define NODE_ONLINE_PATH "/sys/devices/system/node/online"
+
+// numastat 与 vmstat 中关心的键，先比较长度再 memcmp，其余的行只花一次长度比较
+typedef struct {
+    const char *key;
+    size_t len;
+    size_t offset;
+} NodeCounterKey;
+
+#define NODE_COUNTER(literal, field) { literal, sizeof(literal) - 1, offsetof(NodeStats, field) }
+
+static const NodeCounterKey node_counter_keys[] = {
+    NODE_COUNTER("numa_hit", numa_hit),
+    NODE_COUNTER("numa_miss", numa_miss),
+    NODE_COUNTER("numa_foreign", numa_foreign),
+    NODE_COUNTER("interleave_hit", interleave_hit),
+    NODE_COUNTER("local_node", local_node),
+    NODE_COUNTER("other_node", other_node),
+    NODE_COUNTER("workingset_refault_anon", workingset_refault_anon),
+    NODE_COUNTER("workingset_refault_file", workingset_refault_file),
+    NODE_COUNTER("pgpromote_success", pgpromote_success),
+    NODE_COUNTER("pgdemote_kswapd", pgdemote_kswapd),
+    NODE_COUNTER("pgdemote_direct", pgdemote_direct),
+};
+
+void parse_node_counters(const char *buf, size_t len, NodeStats *stats) {
+    const char *p = buf;
+    const char *end = buf + len;
+
+    while (p < end) {
+        const char *next = proc_next_line(p, end);
+        const char *key;
+        size_t key_len;
+        unsigned long value;
+        const char *q = proc_parse_token(p, next, &key, &key_len);
+
+        if (q && proc_parse_ulong(q, next, &value)) {
+            for (size_t i = 0; i < sizeof(node_counter_keys) / sizeof(node_counter_keys[0]); i++) {
+                const NodeCounterKey *k = &node_counter_keys[i];
+                if (k->len == key_len && memcmp(k->key, key, key_len) == 0) {
+                    *(unsigned long *)((char *)stats + k->offset) = value;
+                    break;
+                }
+            }
+        }
+        p = next;
+    }
+}
+
+static void add_node(NumaRegistry *reg, unsigned long node) {
+    if (reg->count >= NUMA_MAX_NODES) return;
+
+    NumaNodeFiles *files = &reg->files[reg->count];
+    snprintf(files->paths[0], NUMA_NODE_PATH_LEN, "/sys/devices/system/node/node%lu/meminfo", node);
+    snprintf(files->paths[1], NUMA_NODE_PATH_LEN, "/sys/devices/system/node/node%lu/numastat", node);
+    snprintf(files->paths[2], NUMA_NODE_PATH_LEN, "/sys/devices/system/node/node%lu/vmstat", node);
+    files->meminfo = (ProcFile)PROC_FILE_INIT(files->paths[0]);
+    files->numastat = (ProcFile)PROC_FILE_INIT(files->paths[1]);
+    files->vmstat = (ProcFile)PROC_FILE_INIT(files->paths[2]);
+
+    memset(&reg->nodes[reg->count], 0, sizeof(NodeStats));
+    reg->nodes[reg->count].node = (unsigned int)node;
+    reg->count++;
+}
+
+int numa_registry_init(NumaRegistry *reg) {
+    ProcFile online = PROC_FILE_INIT(NODE_ONLINE_PATH);
+
+    memset(reg, 0, sizeof(*reg));
+    if (proc_file_read(&online) < 0) {
+        proc_file_close(&online);
+        return -1;
+    }
+
+    // 格式如 "0-3,6"
+    const char *p = online.buf;
+    const char *end = online.buf + online.len;
+    while (p < end) {
+        unsigned long first, last;
+
+        if (!(p = proc_parse_ulong(p, end, &first))) break;
+        last = first;
+        if (p < end && *p == '-' && !(p = proc_parse_ulong(p + 1, end, &last))) break;
+        for (unsigned long node = first; node <= last; node++) add_node(reg, node);
+        if (p >= end || *p != ',') break;
+        p++;
+    }
+    proc_file_close(&online);
+    return reg->count > 0 ? 0 : -1;
+}
+
+void numa_registry_free(NumaRegistry *reg) {
+    for (int i = 0; i < reg->count; i++) {
+        proc_file_close(&reg->files[i].meminfo);
+        proc_file_close(&reg->files[i].numastat);
+        proc_file_close(&reg->files[i].vmstat);
+    }
+    reg->count = 0;
+}
+
+int numa_registry_update(NumaRegistry *reg) {
+    MemInfo mem;
+    int ok = 0;
+
+    for (int i = 0; i < reg->count; i++) {
+        NumaNodeFiles *files = &reg->files[i];
+        NodeStats *stats = &reg->nodes[i];
+        unsigned int node = stats->node;
+
+        // 节点下线时文件消失，读取失败，fd 在下次采集时重新打开
+        if (proc_file_read(&files->meminfo) < 0 || proc_file_read(&files->numastat) < 0) {
+            stats->valid = 0;
+            continue;
+        }
+        memset(stats, 0, sizeof(*stats));
+        stats->node = node;
+
+        parse_node_meminfo(files->meminfo.buf, files->meminfo.len, &mem);
+        stats->mem_total = mem.mem_total;
+        stats->mem_free = mem.mem_free;
+        stats->file = mem.active_file + mem.inactive_file;
+        stats->anon = mem.anon_pages;
+        stats->shmem = mem.shmem;
+        stats->slab_reclaimable = mem.sreclaimable;
+
+        // 先解析 vmstat 再解析 numastat：新内核的节点 vmstat 也带 numa_* 计数，以 numastat 为准
+        if (proc_file_read(&files->vmstat) >= 0) {
+            parse_node_counters(files->vmstat.buf, files->vmstat.len, stats);
+        }
+        parse_node_counters(files->numastat.buf, files->numastat.len, stats);
+
+        stats->valid = 1;
+        ok++;
+    }
+    return ok;
+}
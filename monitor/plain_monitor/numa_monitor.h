@@ -0,0 +1,64 @@
+#ifndef NUMA_MONITOR_H
+#define NUMA_MONITOR_H
+
+#include <stdint.h>
+#include "proc_parser.h"
+
+// 每个 NUMA 节点的内存与分配统计
+// 数据来自 /sys/devices/system/node/node<n>/{meminfo,numastat,vmstat}，
+// 每个节点三个常驻 fd，一次采集在同一个回调里读完所有节点，各节点的数据时间上基本一致。
+
+#define NUMA_MAX_NODES 64
+#define NUMA_NODE_PATH_LEN 64
+
+// 单个节点的统计，原样发布到共享内存快照；exporter 按字段顺序读取（NodeStatNames），新增字段追加在末尾
+typedef struct {
+    unsigned int node;              // 节点号
+    unsigned int valid;             // 本次采集成功；节点下线或读取失败时为0
+    // meminfo（kB）
+    unsigned long mem_total;        // MemTotal
+    unsigned long mem_free;         // MemFree
+    unsigned long file;             // Active(file) + Inactive(file)
+    unsigned long anon;             // AnonPages
+    unsigned long shmem;            // Shmem
+    unsigned long slab_reclaimable; // SReclaimable
+    // numastat（页数，累计）
+    unsigned long numa_hit;         // 期望在本节点分配且分配成功
+    unsigned long numa_miss;        // 期望在其他节点、因其内存不足落到本节点
+    unsigned long numa_foreign;     // 期望在本节点、因本节点内存不足落到其他节点
+    unsigned long interleave_hit;
+    unsigned long local_node;       // 本节点上运行的进程在本节点分配
+    unsigned long other_node;       // 其他节点上运行的进程在本节点分配
+    // vmstat（累计）
+    unsigned long workingset_refault_anon;
+    unsigned long workingset_refault_file;
+    unsigned long pgpromote_success;
+    unsigned long pgdemote_kswapd;
+    unsigned long pgdemote_direct;
+} NodeStats;
+
+// 单个节点的常驻文件句柄
+typedef struct {
+    char paths[3][NUMA_NODE_PATH_LEN];
+    ProcFile meminfo;
+    ProcFile numastat;
+    ProcFile vmstat;
+} NumaNodeFiles;
+
+typedef struct {
+    NodeStats nodes[NUMA_MAX_NODES];
+    NumaNodeFiles files[NUMA_MAX_NODES];
+    int count;                      // 节点数
+} NumaRegistry;
+
+// 按 /sys/devices/system/node/online 建立节点列表，没有 NUMA 支持时返回-1
+int numa_registry_init(NumaRegistry *reg);
+void numa_registry_free(NumaRegistry *reg);
+
+// 读取所有节点，返回成功读取的节点数
+int numa_registry_update(NumaRegistry *reg);
+
+// 解析 numastat / vmstat 这类 "key value" 格式的内容（节点 vmstat 包含 numa_* 时同样会写入）
+void parse_node_counters(const char *buf, size_t len, NodeStats *stats);
+
+#endif // NUMA_MONITOR_H
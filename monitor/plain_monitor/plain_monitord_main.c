@@ -0,0 +1,272 @@
+// 单进程采集守护进程：所有 plain_monitor 采集器在同一个线程中由 collector_scheduler 调度
+#include "collector_scheduler.h"
+#include "cpu_load_monitor.h"
+#include "disk_monitor.h"
+#include "mem_monitor.h"
+#include "numa_monitor.h"
+#include "psi_monitor.h"
+#include "snapshot_shm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#define NSEC_PER_MSEC 1000000ULL
+#define MAX_PSI_CGROUPS 16
+
+typedef struct MonitorState MonitorState;
+
+// 每个 PSI 触发器作为一个事件驱动的采集器，回调上下文指明是哪一个触发器
+typedef struct {
+    MonitorState *state;
+    int index;
+    char name[24];
+} PsiEvent;
+
+// 各采集器最近一次的结果
+struct MonitorState {
+    LoadAvgData load;
+    LoadEstimator load_est;
+    MemInfo mem;
+    DiskRegistry disks;
+    NumaRegistry numa;
+    PsiMonitor psi;
+    PsiEvent psi_events[PSI_MAX_TRIGGERS];
+    SnapshotShm snapshot;       // 发布给 exporter 的共享内存快照
+    CollectorScheduler *sched;
+};
+
+static CollectorScheduler scheduler;
+
+static void handle_signal(int signo) {
+    (void)signo;
+    collector_scheduler_stop(&scheduler);
+}
+
+static int collect_loadavg(void *ctx) {
+    MonitorState *state = ctx;
+    if (get_loadavg_data(&state->load) != 0) return -1;
+    snapshot_publish_loadavg(&state->snapshot, &state->load);
+    return 0;
+}
+
+// 负载估计器每次采样后立即发布，1 秒窗口的负载不必等 loadavg 的周期
+static int collect_load_estimate(void *ctx) {
+    MonitorState *state = ctx;
+    if (load_estimator_sample(&state->load_est) != 0) return -1;
+    state->load.load_1s = state->load_est.load_1s;
+    state->load.load_10s = state->load_est.load_10s;
+    state->load.load_60s = state->load_est.load_60s;
+    snapshot_publish_loadavg(&state->snapshot, &state->load);
+    return 0;
+}
+
+static int collect_meminfo(void *ctx) {
+    MonitorState *state = ctx;
+    if (get_meminfo(&state->mem) != 0) return -1;
+    snapshot_publish_meminfo(&state->snapshot, &state->mem);
+    return 0;
+}
+
+static int collect_diskstats(void *ctx) {
+    MonitorState *state = ctx;
+    if (disk_registry_update(&state->disks) < 0) return -1;
+    snapshot_publish_disks(&state->snapshot, &state->disks);
+    return 0;
+}
+
+// 所有节点在一次回调内读完，节点多时也只占用一个调度周期
+static int collect_numa(void *ctx) {
+    MonitorState *state = ctx;
+    int ok = numa_registry_update(&state->numa);
+
+    snapshot_publish_numa(&state->snapshot, &state->numa);
+    return ok == state->numa.count ? 0 : -1;
+}
+
+// PSI 触发器就绪：记录事件后立即发布，不等下一个周期
+static int collect_psi(void *ctx) {
+    PsiEvent *event = ctx;
+    MonitorState *state = event->state;
+    int ret = psi_monitor_handle(&state->psi, event->index);
+
+    snapshot_publish_psi(&state->snapshot, &state->psi);
+    return ret;
+}
+
+// 为系统级以及每个 cgroup 的 cpu/memory/io 注册触发器；注册失败（例如内核未开启 PSI）只打印警告
+static int setup_psi(MonitorState *state, CollectorScheduler *sched, const char *trigger,
+                     const char **cgroups, int cgroup_count) {
+    for (int g = -1; g < cgroup_count; g++) {
+        const char *cgroup = g < 0 ? NULL : cgroups[g];
+        for (uint32_t res = 0; res < PSI_RESOURCES; res++) {
+            int index = psi_monitor_add(&state->psi, cgroup, res, trigger);
+            if (index < 0) {
+                fprintf(stderr, "跳过 PSI 触发器 %s %s\n", cgroup ? cgroup : "(system)",
+                        psi_resource_name(res));
+                continue;
+            }
+            PsiEvent *event = &state->psi_events[index];
+            event->state = state;
+            event->index = index;
+            snprintf(event->name, sizeof(event->name), "psi_%s_%d", psi_resource_name(res), index);
+            // 触发器的事件以 EPOLLPRI 通知
+            if (collector_scheduler_add_fd(sched, event->name, psi_monitor_fd(&state->psi, index),
+                                           EPOLLPRI, collect_psi, event) < 0) {
+                return -1;
+            }
+        }
+    }
+    snapshot_publish_psi(&state->snapshot, &state->psi);
+    return 0;
+}
+
+// 定期打印最新结果与各采集器的运行统计
+static int report(void *ctx) {
+    MonitorState *state = ctx;
+    CollectorScheduler *sched = state->sched;
+
+    printf("\n[load] 1min %.2f 5min %.2f 15min %.2f (%d cpus), 1s %.2f 10s %.2f 60s %.2f\n",
+           state->load.load_1min, state->load.load_5min, state->load.load_15min,
+           state->load.cpu_count, state->load.load_1s, state->load.load_10s, state->load.load_60s);
+    printf("[mem]  total %lu kB, available %lu kB, dirty %lu kB\n",
+           state->mem.mem_total, state->mem.mem_available, state->mem.dirty);
+    for (int i = 0; i < state->disks.device_high; i++) {
+        const DiskDevice *dev = &state->disks.devices[i];
+        if (!dev->in_use) continue;
+        printf("[disk] %-12s r %8.2f MB/s w %8.2f MB/s util %6.2f%%\n",
+               dev->current.name, dev->current.read_throughput_mb,
+               dev->current.write_throughput_mb, dev->current.utilization);
+    }
+    for (int i = 0; i < state->numa.count; i++) {
+        const NodeStats *n = &state->numa.nodes[i];
+        if (!n->valid) continue;
+        printf("[numa] node%-3u free %lu kB, file %lu kB, anon %lu kB, miss %lu, foreign %lu\n",
+               n->node, n->mem_free, n->file, n->anon, n->numa_miss, n->numa_foreign);
+    }
+    for (int i = 0; i < state->psi.count; i++) {
+        const PsiTrigger *t = &state->psi.triggers[i];
+        printf("[psi]  %-24s %-6s %s events %llu avg10 %.2f%%%s\n",
+               t->cgroup[0] ? t->cgroup : "(system)", psi_resource_name(t->resource),
+               t->full ? "full" : "some", (unsigned long long)t->events, t->avg10,
+               t->active ? "" : " (removed)");
+    }
+
+    printf("%-10s %10s %10s %10s %12s %12s\n",
+           "collector", "period_ms", "runs", "overruns", "last_us", "max_us");
+    for (int i = 0; i < sched->count; i++) {
+        const Collector *c = &sched->collectors[i];
+        printf("%-10s %10llu %10llu %10llu %12.1f %12.1f\n",
+               c->name,
+               (unsigned long long)(c->period_ns / NSEC_PER_MSEC),
+               (unsigned long long)c->runs,
+               (unsigned long long)c->overruns,
+               c->last_duration_ns / 1000.0,
+               c->max_duration_ns / 1000.0);
+    }
+    fflush(stdout);
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-l load_ms] [-s load_sample_ms] [-m mem_ms] [-d disk_ms] [-n numa_ms]\n"
+            "          [-r report_ms] [-c max_disks] [-t psi_trigger] [-g cgroup]...\n"
+            "  default: load 1000ms, load sample 100ms, mem 1000ms, disk 1000ms, numa 1000ms,\n"
+            "           report 5000ms, %d disks\n"
+            "  psi: \"%s\" on /proc/pressure/{cpu,memory,io} and on each -g cgroup\n"
+            "       (path relative to /sys/fs/cgroup, at most %d)\n"
+            "  snapshots are published to /dev/shm%s\n",
+            prog, SNAPSHOT_DEFAULT_DISKS, PSI_DEFAULT_TRIGGER, MAX_PSI_CGROUPS, SNAPSHOT_SHM_NAME);
+}
+
+int main(int argc, char **argv) {
+    uint64_t load_ms = 1000, sample_ms = 100, mem_ms = 1000, disk_ms = 1000, numa_ms = 1000;
+    uint64_t report_ms = 5000;
+    unsigned long max_disks = SNAPSHOT_DEFAULT_DISKS;
+    const char *psi_trigger = PSI_DEFAULT_TRIGGER;
+    const char *psi_cgroups[MAX_PSI_CGROUPS];
+    int psi_cgroup_count = 0;
+    static MonitorState state;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "l:s:m:d:n:r:c:t:g:h")) != -1) {
+        switch (opt) {
+        case 'l': load_ms = strtoull(optarg, NULL, 10); break;
+        case 's': sample_ms = strtoull(optarg, NULL, 10); break;
+        case 'm': mem_ms = strtoull(optarg, NULL, 10); break;
+        case 'd': disk_ms = strtoull(optarg, NULL, 10); break;
+        case 'n': numa_ms = strtoull(optarg, NULL, 10); break;
+        case 'r': report_ms = strtoull(optarg, NULL, 10); break;
+        case 'c': max_disks = strtoul(optarg, NULL, 10); break;
+        case 't': psi_trigger = optarg; break;
+        case 'g':
+            if (psi_cgroup_count == MAX_PSI_CGROUPS) {
+                usage(argv[0]);
+                return 1;
+            }
+            psi_cgroups[psi_cgroup_count++] = optarg;
+            break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (!load_ms || !sample_ms || !mem_ms || !disk_ms || !numa_ms || !report_ms || !max_disks || max_disks > 65536) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (collector_scheduler_init(&scheduler) != 0) return 1;
+    if (disk_registry_init(&state.disks) != 0) {
+        fprintf(stderr, "无法初始化磁盘注册表\n");
+        return 1;
+    }
+    if (snapshot_shm_create(&state.snapshot, SNAPSHOT_SHM_NAME, (uint32_t)max_disks) != 0) {
+        fprintf(stderr, "无法创建共享内存快照\n");
+        return 1;
+    }
+    state.sched = &scheduler;
+    load_estimator_init(&state.load_est);
+    psi_monitor_init(&state.psi);
+
+    if (collector_scheduler_add(&scheduler, "loadavg", load_ms * NSEC_PER_MSEC, collect_loadavg, &state) < 0 ||
+        collector_scheduler_add(&scheduler, "loadest", sample_ms * NSEC_PER_MSEC, collect_load_estimate, &state) < 0 ||
+        collector_scheduler_add(&scheduler, "meminfo", mem_ms * NSEC_PER_MSEC, collect_meminfo, &state) < 0 ||
+        collector_scheduler_add(&scheduler, "diskstats", disk_ms * NSEC_PER_MSEC, collect_diskstats, &state) < 0 ||
+        collector_scheduler_add(&scheduler, "report", report_ms * NSEC_PER_MSEC, report, &state) < 0) {
+        fprintf(stderr, "无法注册采集器\n");
+        return 1;
+    }
+    // 没有 NUMA 支持（或节点目录不可见）时不注册 numa 采集器，快照中节点数保持为0
+    if (numa_registry_init(&state.numa) != 0) {
+        fprintf(stderr, "未找到 NUMA 节点，跳过 numa 采集\n");
+    } else if (collector_scheduler_add(&scheduler, "numa", numa_ms * NSEC_PER_MSEC, collect_numa, &state) < 0) {
+        fprintf(stderr, "无法注册采集器\n");
+        return 1;
+    }
+    if (setup_psi(&state, &scheduler, psi_trigger, psi_cgroups, psi_cgroup_count) != 0) {
+        fprintf(stderr, "无法注册 PSI 触发器\n");
+        return 1;
+    }
+
+    // 不使用 SA_RESTART，让 epoll_wait 被信号打断后及时退出
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    printf("plain_monitord started: load %llums (sample %llums), mem %llums, disk %llums, %d psi triggers\n",
+           (unsigned long long)load_ms, (unsigned long long)sample_ms, (unsigned long long)mem_ms,
+           (unsigned long long)disk_ms, state.psi.count);
+    int ret = collector_scheduler_run(&scheduler);
+
+    collector_scheduler_destroy(&scheduler);
+    disk_registry_free(&state.disks);
+    psi_monitor_free(&state.psi);
+    numa_registry_free(&state.numa);
+    // 保留共享内存对象，守护进程停止期间 exporter 仍能读到最后一次快照（update_time_ns 不再前进）
+    snapshot_shm_close(&state.snapshot, SNAPSHOT_SHM_NAME, 0);
+    return ret == 0 ? 0 : 1;
+}
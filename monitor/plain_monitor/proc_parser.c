@@ -0,0 +1,69 @@
+#include "proc_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define PROC_FILE_INITIAL_CAP 4096
+
+int proc_file_open(ProcFile *pf, const char *path) {
+    if (path) pf->path = path;
+    if (pf->fd >= 0) return 0;
+
+    pf->fd = open(pf->path, O_RDONLY | O_CLOEXEC);
+    if (pf->fd < 0) {
+        perror(pf->path);
+        return -1;
+    }
+    return 0;
+}
+
+// 扩容读缓冲区，保留已读内容
+static int proc_file_grow(ProcFile *pf) {
+    size_t new_cap = pf->cap ? pf->cap * 2 : PROC_FILE_INITIAL_CAP;
+    char *new_buf = realloc(pf->buf, new_cap);
+    if (!new_buf) return -1;
+    pf->buf = new_buf;
+    pf->cap = new_cap;
+    return 0;
+}
+
+long proc_file_read(ProcFile *pf) {
+    if (pf->fd < 0 && proc_file_open(pf, NULL) != 0) return -1;
+
+    pf->len = 0;
+    while (1) {
+        // 预留1字节给结尾的 '\0'
+        if (pf->cap - pf->len < 2 && proc_file_grow(pf) != 0) break;
+
+        // seq_file 每次最多返回一页左右的数据，短读并不代表文件结束，需要读到返回0为止
+        ssize_t n = pread(pf->fd, pf->buf + pf->len, pf->cap - pf->len - 1, (off_t)pf->len);
+        if (n > 0) {
+            pf->len += (size_t)n;
+            continue;
+        }
+        if (n == 0) {
+            pf->buf[pf->len] = '\0';
+            return (long)pf->len;
+        }
+        if (errno == EINTR) continue;
+        break;
+    }
+
+    // 读取失败：关闭fd，下次采样时重新打开（例如文件所在的设备/cgroup已被移除后重建）
+    perror(pf->path);
+    close(pf->fd);
+    pf->fd = -1;
+    pf->len = 0;
+    return -1;
+}
+
+void proc_file_close(ProcFile *pf) {
+    if (pf->fd >= 0) close(pf->fd);
+    free(pf->buf);
+    pf->fd = -1;
+    pf->buf = NULL;
+    pf->cap = 0;
+    pf->len = 0;
+}
@@ -0,0 +1,89 @@
+#ifndef PROC_PARSER_H
+#define PROC_PARSER_H
+
+#include <stddef.h>
+
+// 常驻的 /proc 文件句柄
+// fd 在首次读取时打开并一直保持，之后每次采样用 pread 从偏移0重新读取到复用缓冲区，
+// 稳态下不再有 open/close 和内存分配
+typedef struct {
+    const char *path;   // 文件路径
+    int fd;             // 常驻文件描述符，-1 表示尚未打开
+    char *buf;          // 复用的读缓冲区（容量不足时按倍数扩容，之后保留）
+    size_t cap;         // 缓冲区容量
+    size_t len;         // 最近一次读取的有效字节数
+} ProcFile;
+
+#define PROC_FILE_INIT(file_path) { (file_path), -1, NULL, 0, 0 }
+
+// 打开文件（proc_file_read 会按需自动调用）
+int proc_file_open(ProcFile *pf, const char *path);
+
+// 重新读取整个文件，返回有效字节数，失败返回-1（下次读取时会重新打开）
+long proc_file_read(ProcFile *pf);
+
+// 关闭文件并释放缓冲区
+void proc_file_close(ProcFile *pf);
+
+// ---- 手写扫描器：都以 [p, end) 为输入，不依赖 '\0' 结尾 ----
+
+static inline const char *proc_skip_spaces(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+// 返回下一行的起始位置
+static inline const char *proc_next_line(const char *p, const char *end) {
+    while (p < end && *p != '\n') p++;
+    return (p < end) ? p + 1 : end;
+}
+
+// 解析无符号十进制整数（跳过前导空白），没有数字时返回NULL
+static inline const char *proc_parse_ulong(const char *p, const char *end, unsigned long *out) {
+    unsigned long value = 0;
+    const char *start;
+
+    p = proc_skip_spaces(p, end);
+    start = p;
+    while (p < end && (unsigned char)(*p - '0') <= 9) {
+        value = value * 10 + (unsigned long)(*p - '0');
+        p++;
+    }
+    if (p == start) return NULL;
+    *out = value;
+    return p;
+}
+
+// 解析形如 "1.23" 的非负定点小数（跳过前导空白），没有数字时返回NULL
+static inline const char *proc_parse_decimal(const char *p, const char *end, double *out) {
+    unsigned long int_part = 0, frac_part = 0, frac_scale = 1;
+
+    p = proc_parse_ulong(p, end, &int_part);
+    if (!p) return NULL;
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && (unsigned char)(*p - '0') <= 9) {
+            frac_part = frac_part * 10 + (unsigned long)(*p - '0');
+            frac_scale *= 10;
+            p++;
+        }
+    }
+    *out = (double)int_part + (double)frac_part / (double)frac_scale;
+    return p;
+}
+
+// 提取一个以空白分隔的字段（跳过前导空白），没有字段时返回NULL
+static inline const char *proc_parse_token(const char *p, const char *end,
+                                           const char **token, size_t *token_len) {
+    const char *start;
+
+    p = proc_skip_spaces(p, end);
+    start = p;
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\n') p++;
+    if (p == start) return NULL;
+    *token = start;
+    *token_len = (size_t)(p - start);
+    return p;
+}
+
+#endif // PROC_PARSER_H
@@ -0,0 +1,175 @@
+// 基准测试：常驻fd + pread + 手写扫描器 对比 原 fopen/fgets/sscanf/fclose 实现
+#include "cpu_load_monitor.h"
+#include "disk_monitor.h"
+#include "mem_monitor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_DISKS 1024
+
+// ---- 原实现（逐行 fopen/fgets/sscanf），仅作为对比基线 ----
+
+static void legacy_parse_meminfo_line(const char *line, MemInfo *info) {
+    char key[32];
+    unsigned long value;
+    const char *colon = strchr(line, ':');
+
+    if (!colon) return;
+
+    size_t key_len = colon - line;
+    if (key_len >= sizeof(key)) return;
+    strncpy(key, line, key_len);
+    key[key_len] = '\0';
+
+    const char *value_str = colon + 1;
+    while (*value_str && isspace(*value_str)) value_str++;
+
+    if (sscanf(value_str, "%lu", &value) == 1) {
+        if (strcmp(key, "MemTotal") == 0) info->mem_total = value;
+        else if (strcmp(key, "MemFree") == 0) info->mem_free = value;
+        else if (strcmp(key, "MemAvailable") == 0) info->mem_available = value;
+        else if (strcmp(key, "Buffers") == 0) info->buffers = value;
+        else if (strcmp(key, "Cached") == 0) info->cached = value;
+        else if (strcmp(key, "SwapTotal") == 0) info->swap_total = value;
+        else if (strcmp(key, "SwapFree") == 0) info->swap_free = value;
+    }
+}
+
+static int legacy_get_meminfo(MemInfo *info) {
+    FILE *fp = fopen("/proc/meminfo", "r");
+    if (!fp) return -1;
+
+    char line[256];
+    memset(info, 0, sizeof(MemInfo));
+    while (fgets(line, sizeof(line), fp)) {
+        legacy_parse_meminfo_line(line, info);
+    }
+    fclose(fp);
+    return 0;
+}
+
+static int legacy_get_diskstats(DiskStats *stats, int max_count) {
+    FILE *fp = fopen("/proc/diskstats", "r");
+    if (!fp) return -1;
+
+    char line[512];
+    int count = 0;
+    while (fgets(line, sizeof(line), fp) && count < max_count) {
+        DiskStats disk;
+        memset(&disk, 0, sizeof(disk));
+        int fields = sscanf(line,
+            "%*d %*d %31s %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu",
+            disk.name, &disk.reads_completed, &disk.reads_merged, &disk.sectors_read,
+            &disk.time_reading_ms, &disk.writes_completed, &disk.writes_merged,
+            &disk.sectors_written, &disk.time_writing_ms, &disk.ios_in_progress,
+            &disk.time_io_ms, &disk.weighted_time_io_ms);
+        if (fields == 12 && strncmp(disk.name, "ram", 3) != 0 && strncmp(disk.name, "loop", 4) != 0) {
+            stats[count++] = disk;
+        }
+    }
+    fclose(fp);
+    return count;
+}
+
+static int legacy_get_loadavg(LoadAvgData *data) {
+    FILE *fp = fopen("/proc/loadavg", "r");
+    if (!fp) return -1;
+
+    char line[256];
+    if (!fgets(line, sizeof(line), fp)) {
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+    if (sscanf(line, "%lf %lf %lf", &data->load_1min, &data->load_5min, &data->load_15min) != 3) {
+        return -1;
+    }
+
+    data->cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (data->cpu_count <= 0) data->cpu_count = 1;
+    data->load_1min_per_core = data->load_1min / data->cpu_count;
+    data->load_5min_per_core = data->load_5min / data->cpu_count;
+    data->load_15min_per_core = data->load_15min / data->cpu_count;
+    return 0;
+}
+
+// ---- 计时 ----
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// 仅解析（不含系统调用）：旧版逐行拷贝后 strcmp 链匹配7个字段，新版按长度分派匹配全部字段
+static char meminfo_text[8192];
+static size_t meminfo_text_len;
+
+static void load_meminfo_text(void) {
+    FILE *fp = fopen("/proc/meminfo", "r");
+    if (!fp) return;
+    meminfo_text_len = fread(meminfo_text, 1, sizeof(meminfo_text) - 1, fp);
+    meminfo_text[meminfo_text_len] = '\0';
+    fclose(fp);
+}
+
+static MemInfo mem_sink;
+
+static void bench_legacy_meminfo_parse(void) {
+    const char *p = meminfo_text;
+    char line[256];
+
+    memset(&mem_sink, 0, sizeof(mem_sink));
+    while (*p) {
+        const char *nl = strchr(p, '\n');
+        size_t len = nl ? (size_t)(nl - p + 1) : strlen(p);
+        if (len >= sizeof(line)) len = sizeof(line) - 1;
+        memcpy(line, p, len);
+        line[len] = '\0';
+        legacy_parse_meminfo_line(line, &mem_sink);
+        p += len;
+    }
+}
+
+static void bench_new_meminfo_parse(void) { parse_meminfo(meminfo_text, meminfo_text_len, &mem_sink); }
+
+static DiskStats disk_sink[BENCH_DISKS];
+static LoadAvgData load_sink;
+
+static void bench_legacy_meminfo(void) { legacy_get_meminfo(&mem_sink); }
+static void bench_new_meminfo(void) { get_meminfo(&mem_sink); }
+static void bench_legacy_diskstats(void) { legacy_get_diskstats(disk_sink, BENCH_DISKS); }
+static void bench_new_diskstats(void) { get_diskstats(disk_sink, BENCH_DISKS); }
+static void bench_legacy_loadavg(void) { legacy_get_loadavg(&load_sink); }
+static void bench_new_loadavg(void) { get_loadavg_data(&load_sink); }
+
+static double run(void (*fn)(void), int iterations) {
+    fn();  // 预热：首次调用会打开fd并分配缓冲区
+    double start = now_ns();
+    for (int i = 0; i < iterations; i++) fn();
+    return (now_ns() - start) / iterations;
+}
+
+static void report(const char *name, void (*legacy)(void), void (*fast)(void), int iterations) {
+    double legacy_ns = run(legacy, iterations);
+    double fast_ns = run(fast, iterations);
+    printf("%-14s %12.0f %12.0f %8.2fx\n", name, legacy_ns, fast_ns, legacy_ns / fast_ns);
+}
+
+int main(int argc, char **argv) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 20000;
+    if (iterations <= 0) iterations = 20000;
+
+    printf("iterations: %d\n", iterations);
+    printf("%-14s %12s %12s %9s\n", "file", "legacy(ns)", "pread(ns)", "speedup");
+    load_meminfo_text();
+    report("meminfo", bench_legacy_meminfo, bench_new_meminfo, iterations);
+    report("meminfo-parse", bench_legacy_meminfo_parse, bench_new_meminfo_parse, iterations);
+    report("diskstats", bench_legacy_diskstats, bench_new_diskstats, iterations);
+    report("loadavg", bench_legacy_loadavg, bench_new_loadavg, iterations);
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "psi_monitor.h"
+#include "proc_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PSI_READ_BUF 256
+
+static const char *const resource_names[PSI_RESOURCES] = { "cpu", "memory", "io" };
+
+const char *psi_resource_name(uint32_t resource) {
+    return resource < PSI_RESOURCES ? resource_names[resource] : "unknown";
+}
+
+static uint64_t realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// 跳到下一个 '=' 之后
+static const char *skip_key(const char *p, const char *end) {
+    while (p < end && *p != '=' && *p != '\n') p++;
+    return (p < end && *p == '=') ? p + 1 : NULL;
+}
+
+// 解析 "some avg10=0.00 avg60=0.00 avg300=0.00 total=0" 中与触发器同类型的一行
+static int parse_pressure(const char *buf, const char *end, PsiTrigger *t) {
+    const char *kind = t->full ? "full" : "some";
+
+    for (const char *line = buf; line < end; line = proc_next_line(line, end)) {
+        const char *p = line;
+        unsigned long total;
+
+        if (end - line < 4 || memcmp(line, kind, 4) != 0) continue;
+        if (!(p = skip_key(p, end)) || !(p = proc_parse_decimal(p, end, &t->avg10))) return -1;
+        if (!(p = skip_key(p, end)) || !(p = proc_parse_decimal(p, end, &t->avg60))) return -1;
+        if (!(p = skip_key(p, end)) || !(p = proc_parse_decimal(p, end, &t->avg300))) return -1;
+        if (!(p = skip_key(p, end)) || !(p = proc_parse_ulong(p, end, &total))) return -1;
+        t->total_us = total;
+        return 0;
+    }
+    return -1;
+}
+
+// 从偏移0重新读取压力文件，触发器 fd 上的读取不影响已注册的触发条件
+static int read_pressure(int fd, PsiTrigger *t) {
+    char buf[PSI_READ_BUF];
+    ssize_t n;
+
+    do {
+        n = pread(fd, buf, sizeof(buf), 0);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) return -1;
+    return parse_pressure(buf, buf + n, t);
+}
+
+void psi_monitor_init(PsiMonitor *mon) {
+    memset(mon, 0, sizeof(*mon));
+    for (int i = 0; i < PSI_MAX_TRIGGERS; i++) mon->fds[i] = -1;
+}
+
+int psi_monitor_add(PsiMonitor *mon, const char *cgroup, uint32_t resource, const char *trigger) {
+    char path[PSI_CGROUP_LEN + 64];
+    char kind[8];
+    unsigned long stall_us, window_us;
+
+    if (mon->count >= PSI_MAX_TRIGGERS || resource >= PSI_RESOURCES) return -1;
+    if (sscanf(trigger, "%7s %lu %lu", kind, &stall_us, &window_us) != 3 ||
+        (strcmp(kind, "some") != 0 && strcmp(kind, "full") != 0)) {
+        fprintf(stderr, "非法的 PSI 触发条件: %s\n", trigger);
+        return -1;
+    }
+    if (cgroup && strlen(cgroup) >= PSI_CGROUP_LEN) {
+        fprintf(stderr, "cgroup 路径过长: %s\n", cgroup);
+        return -1;
+    }
+
+    if (cgroup && cgroup[0]) {
+        snprintf(path, sizeof(path), "/sys/fs/cgroup/%s/%s.pressure", cgroup, resource_names[resource]);
+    } else {
+        snprintf(path, sizeof(path), "/proc/pressure/%s", resource_names[resource]);
+    }
+
+    int fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    // 内核要求写入内容包含结尾的 '\0'；每个 fd 只能注册一个触发器，关闭 fd 即注销
+    if (write(fd, trigger, strlen(trigger) + 1) < 0) {
+        fprintf(stderr, "%s: 注册触发器 \"%s\" 失败: %s\n", path, trigger, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    int index = mon->count;
+    PsiTrigger *t = &mon->triggers[index];
+    memset(t, 0, sizeof(*t));
+    if (cgroup) strcpy(t->cgroup, cgroup);
+    t->resource = resource;
+    t->full = kind[0] == 'f';
+    t->active = 1;
+    t->stall_us = stall_us;
+    t->window_us = window_us;
+    read_pressure(fd, t);
+
+    mon->fds[index] = fd;
+    mon->count++;
+    return index;
+}
+
+int psi_monitor_fd(const PsiMonitor *mon, int index) {
+    return (index >= 0 && index < mon->count) ? mon->fds[index] : -1;
+}
+
+int psi_monitor_handle(PsiMonitor *mon, int index) {
+    if (index < 0 || index >= mon->count || mon->fds[index] < 0) return -1;
+    PsiTrigger *t = &mon->triggers[index];
+
+    // 时间戳先于读取，尽量贴近内核发出事件的时刻
+    uint64_t now = realtime_ns();
+
+    // cgroup 被删除后 fd 持续返回 EPOLLERR|EPOLLPRI，读取失败；关闭 fd 让它退出 epoll，避免空转
+    if (read_pressure(mon->fds[index], t) != 0) {
+        close(mon->fds[index]);
+        mon->fds[index] = -1;
+        t->active = 0;
+        return -1;
+    }
+    t->events++;
+    t->last_event_ns = now;
+    return 0;
+}
+
+void psi_monitor_free(PsiMonitor *mon) {
+    for (int i = 0; i < mon->count; i++) {
+        if (mon->fds[i] >= 0) close(mon->fds[i]);
+    }
+    psi_monitor_init(mon);
+}
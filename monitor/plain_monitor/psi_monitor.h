@@ -0,0 +1,62 @@
+#ifndef PSI_MONITOR_H
+#define PSI_MONITOR_H
+
+#include <stdint.h>
+
+// PSI（Pressure Stall Information）触发器
+// 向 /proc/pressure/<资源> 或 cgroup 的 <资源>.pressure 写入 "some 150000 1000000" 这样的触发条件后，
+// 内核在 window 内累计停顿超过 stall 时让该 fd 出现 EPOLLPRI。fd 直接注册到 collector_scheduler 的 epoll，
+// 停顿发生后毫秒级被唤醒，期间不需要任何轮询。
+// 注意不能先放进另一个 epoll 再嵌套注册：外层 epoll 探测就绪时的 poll 会清掉触发器的事件标志，内层就收不到了。
+
+#define PSI_MAX_TRIGGERS 64
+#define PSI_CGROUP_LEN 128
+// 1 秒内累计停顿 150ms；window 须在 0.5~10 秒之间，没有 CAP_SYS_RESOURCE 时还必须是 2 秒的整数倍
+#define PSI_DEFAULT_TRIGGER "some 150000 1000000"
+
+// 资源类型
+#define PSI_CPU 0
+#define PSI_MEMORY 1
+#define PSI_IO 2
+#define PSI_RESOURCES 3
+
+// 单个触发器的状态，原样发布到共享内存快照
+typedef struct {
+    char cgroup[PSI_CGROUP_LEN];  // 相对 /sys/fs/cgroup 的路径，系统级为空串
+    uint32_t resource;            // PSI_CPU / PSI_MEMORY / PSI_IO
+    uint16_t full;                // 0 表示 some，1 表示 full
+    uint16_t active;              // 触发器有效；cgroup 被删除后置0
+    uint64_t stall_us;            // 触发条件：window_us 内累计停顿超过 stall_us
+    uint64_t window_us;
+    uint64_t events;              // 触发次数
+    uint64_t last_event_ns;       // 最近一次触发的时间（CLOCK_REALTIME，纳秒），未触发过为0
+    double avg10;                 // 最近一次触发（或注册）时读到的停顿百分比
+    double avg60;
+    double avg300;
+    uint64_t total_us;            // 同一时刻的累计停顿时间
+} PsiTrigger;
+
+typedef struct {
+    PsiTrigger triggers[PSI_MAX_TRIGGERS];
+    int fds[PSI_MAX_TRIGGERS];    // 触发器 fd，已失效为-1
+    int count;
+} PsiMonitor;
+
+void psi_monitor_init(PsiMonitor *mon);
+
+// 注册触发器，cgroup 为 NULL 或空串表示系统级；trigger 形如 "some 150000 1000000"
+// 返回触发器下标，失败返回-1（内核未开启 PSI、权限不足或触发条件非法）
+int psi_monitor_add(PsiMonitor *mon, const char *cgroup, uint32_t resource, const char *trigger);
+
+// 触发器的 fd，用于注册到 collector_scheduler（等待 EPOLLPRI）
+int psi_monitor_fd(const PsiMonitor *mon, int index);
+
+// fd 就绪后调用：计数、记录时间并读取当前停顿数据
+// 触发器所在的 cgroup 已被删除时关闭 fd（同时从 epoll 中移除）并返回-1
+int psi_monitor_handle(PsiMonitor *mon, int index);
+
+void psi_monitor_free(PsiMonitor *mon);
+
+const char *psi_resource_name(uint32_t resource);
+
+#endif // PSI_MONITOR_H
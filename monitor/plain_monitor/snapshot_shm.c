@@ -0,0 +1,231 @@
+#include "snapshot_shm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SNAPSHOT_SPIN_BEFORE_YIELD 64
+#define SNAPSHOT_SHM_DIR "/dev/shm"   // Linux 上 shm_open 的对象所在目录，名字以 '/' 开头
+
+static size_t align_up(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+static uint64_t realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static SnapshotSeqlock *section_lock(const SnapshotShm *shm, uint32_t offset) {
+    return (SnapshotSeqlock *)((char *)shm->base + offset);
+}
+
+static void *section_data(const SnapshotShm *shm, uint32_t offset) {
+    return (char *)shm->base + offset + sizeof(SnapshotSeqlock);
+}
+
+// 写端进入临界区：seq 变为奇数，之后的数据写入不会被重排到它之前
+static void seqlock_write_begin(SnapshotSeqlock *lock) {
+    uint64_t seq = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    atomic_store_explicit(&lock->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+// 写端离开临界区：seq 恢复为偶数，release 保证数据先于 seq 可见
+static void seqlock_write_end(SnapshotSeqlock *lock) {
+    uint64_t seq = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    lock->update_time_ns = realtime_ns();
+    atomic_store_explicit(&lock->seq, seq + 1, memory_order_release);
+}
+
+size_t snapshot_shm_region_size(uint32_t disk_capacity) {
+    size_t size = align_up(sizeof(SnapshotHeader), SNAPSHOT_ALIGN);
+    size += align_up(sizeof(SnapshotSeqlock) + sizeof(MemInfo), SNAPSHOT_ALIGN);
+    size += align_up(sizeof(SnapshotSeqlock) + sizeof(LoadAvgData), SNAPSHOT_ALIGN);
+    size += align_up(sizeof(SnapshotSeqlock) + sizeof(SnapshotDiskCount) +
+                     (size_t)disk_capacity * sizeof(DiskStats), SNAPSHOT_ALIGN);
+    size += align_up(sizeof(SnapshotSeqlock) + sizeof(SnapshotPsiCount) +
+                     PSI_MAX_TRIGGERS * sizeof(PsiTrigger), SNAPSHOT_ALIGN);
+    size += align_up(sizeof(SnapshotSeqlock) + sizeof(SnapshotNumaCount) +
+                     NUMA_MAX_NODES * sizeof(NodeStats), SNAPSHOT_ALIGN);
+    return size;
+}
+
+void snapshot_shm_format(SnapshotShm *shm, void *base, size_t size, uint32_t disk_capacity) {
+    SnapshotHeader *header = base;
+    size_t offset = align_up(sizeof(SnapshotHeader), SNAPSHOT_ALIGN);
+
+    memset(base, 0, size);
+    header->region_size = (uint32_t)size;
+    header->disk_capacity = disk_capacity;
+
+    header->mem_offset = (uint32_t)offset;
+    header->mem_size = sizeof(MemInfo);
+    offset += align_up(sizeof(SnapshotSeqlock) + sizeof(MemInfo), SNAPSHOT_ALIGN);
+
+    header->load_offset = (uint32_t)offset;
+    header->load_size = sizeof(LoadAvgData);
+    offset += align_up(sizeof(SnapshotSeqlock) + sizeof(LoadAvgData), SNAPSHOT_ALIGN);
+
+    header->disk_offset = (uint32_t)offset;
+    header->disk_entry_size = sizeof(DiskStats);
+    offset += align_up(sizeof(SnapshotSeqlock) + sizeof(SnapshotDiskCount) +
+                       (size_t)disk_capacity * sizeof(DiskStats), SNAPSHOT_ALIGN);
+
+    header->psi_offset = (uint32_t)offset;
+    header->psi_entry_size = sizeof(PsiTrigger);
+    SnapshotPsiCount *psi = (SnapshotPsiCount *)((char *)base + offset + sizeof(SnapshotSeqlock));
+    psi->capacity = PSI_MAX_TRIGGERS;
+    offset += align_up(sizeof(SnapshotSeqlock) + sizeof(SnapshotPsiCount) +
+                       PSI_MAX_TRIGGERS * sizeof(PsiTrigger), SNAPSHOT_ALIGN);
+
+    header->numa_offset = (uint32_t)offset;
+    header->numa_entry_size = sizeof(NodeStats);
+    SnapshotNumaCount *numa = (SnapshotNumaCount *)((char *)base + offset + sizeof(SnapshotSeqlock));
+    numa->capacity = NUMA_MAX_NODES;
+
+    header->writer_pid = (uint64_t)getpid();
+    header->version = SNAPSHOT_VERSION;
+    // magic 最后写入，读端看到 magic 时布局已经就绪
+    atomic_thread_fence(memory_order_release);
+    header->magic = SNAPSHOT_MAGIC;
+
+    shm->base = base;
+    shm->size = size;
+    shm->header = header;
+}
+
+int snapshot_shm_create(SnapshotShm *shm, const char *name, uint32_t disk_capacity) {
+    size_t size = snapshot_shm_region_size(disk_capacity);
+    char tmp_name[NAME_MAX];
+    char tmp_path[PATH_MAX], path[PATH_MAX];
+
+    // 不能在原对象上 ftruncate/清零：exporter 仍映射着旧对象，缩小后访问会收到 SIGBUS。
+    // 先在临时名字下建好并格式化新对象，再 rename 到正式名字：旧映射继续指向旧 inode，
+    // exporter 发现路径对应的 inode 变化后重新映射，任何时刻按名字打开都能看到完整的布局。
+    snprintf(tmp_name, sizeof(tmp_name), "%s.%d", name, (int)getpid());
+    snprintf(tmp_path, sizeof(tmp_path), SNAPSHOT_SHM_DIR "%s", tmp_name);
+    snprintf(path, sizeof(path), SNAPSHOT_SHM_DIR "%s", name);
+    shm_unlink(tmp_name);   // 同 pid 的上一次运行异常退出时留下的临时对象
+
+    int fd = shm_open(tmp_name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        perror("shm_open");
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(tmp_name);
+        return -1;
+    }
+
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        shm_unlink(tmp_name);
+        return -1;
+    }
+
+    snapshot_shm_format(shm, base, size, disk_capacity);
+    if (rename(tmp_path, path) != 0) {
+        perror("rename");
+        snapshot_shm_close(shm, tmp_name, 1);
+        return -1;
+    }
+    return 0;
+}
+
+void snapshot_shm_close(SnapshotShm *shm, const char *name, int unlink) {
+    if (shm->base) munmap(shm->base, shm->size);
+    if (unlink && name) shm_unlink(name);
+    memset(shm, 0, sizeof(*shm));
+}
+
+void snapshot_publish_meminfo(SnapshotShm *shm, const MemInfo *info) {
+    SnapshotSeqlock *lock = section_lock(shm, shm->header->mem_offset);
+
+    seqlock_write_begin(lock);
+    memcpy(section_data(shm, shm->header->mem_offset), info, sizeof(*info));
+    seqlock_write_end(lock);
+}
+
+void snapshot_publish_loadavg(SnapshotShm *shm, const LoadAvgData *data) {
+    SnapshotSeqlock *lock = section_lock(shm, shm->header->load_offset);
+
+    seqlock_write_begin(lock);
+    memcpy(section_data(shm, shm->header->load_offset), data, sizeof(*data));
+    seqlock_write_end(lock);
+}
+
+void snapshot_publish_disks(SnapshotShm *shm, const DiskRegistry *reg) {
+    SnapshotSeqlock *lock = section_lock(shm, shm->header->disk_offset);
+    SnapshotDiskCount *count = section_data(shm, shm->header->disk_offset);
+    DiskStats *disks = (DiskStats *)(count + 1);
+    uint32_t capacity = shm->header->disk_capacity;
+    uint32_t n = 0, dropped = 0;
+
+    seqlock_write_begin(lock);
+    for (int i = 0; i < reg->device_high; i++) {
+        const DiskDevice *dev = &reg->devices[i];
+        if (!dev->in_use) continue;
+        if (n < capacity) {
+            disks[n++] = dev->current;
+        } else {
+            dropped++;
+        }
+    }
+    count->count = n;
+    count->dropped = dropped;
+    seqlock_write_end(lock);
+}
+
+void snapshot_publish_psi(SnapshotShm *shm, const PsiMonitor *mon) {
+    SnapshotSeqlock *lock = section_lock(shm, shm->header->psi_offset);
+    SnapshotPsiCount *count = section_data(shm, shm->header->psi_offset);
+    PsiTrigger *triggers = (PsiTrigger *)(count + 1);
+
+    seqlock_write_begin(lock);
+    memcpy(triggers, mon->triggers, (size_t)mon->count * sizeof(PsiTrigger));
+    count->count = (uint32_t)mon->count;
+    seqlock_write_end(lock);
+}
+
+void snapshot_publish_numa(SnapshotShm *shm, const NumaRegistry *reg) {
+    SnapshotSeqlock *lock = section_lock(shm, shm->header->numa_offset);
+    SnapshotNumaCount *count = section_data(shm, shm->header->numa_offset);
+    NodeStats *nodes = (NodeStats *)(count + 1);
+
+    seqlock_write_begin(lock);
+    memcpy(nodes, reg->nodes, (size_t)reg->count * sizeof(NodeStats));
+    count->count = (uint32_t)reg->count;
+    seqlock_write_end(lock);
+}
+
+int snapshot_read_meminfo(const SnapshotShm *shm, MemInfo *info, int max_retries) {
+    SnapshotSeqlock *lock = section_lock(shm, shm->header->mem_offset);
+    const void *data = section_data(shm, shm->header->mem_offset);
+
+    for (int retries = 0; retries <= max_retries; retries++) {
+        // 写端在临界区内被抢占时让出CPU，避免在单核或超售环境下空转整个时间片
+        if (retries && (retries % SNAPSHOT_SPIN_BEFORE_YIELD) == 0) sched_yield();
+
+        uint64_t begin = atomic_load_explicit(&lock->seq, memory_order_acquire);
+        if (begin & 1) continue;  // 写端正在写入
+
+        memcpy(info, data, sizeof(*info));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&lock->seq, memory_order_relaxed) == begin) {
+            return retries;
+        }
+    }
+    return -1;
+}
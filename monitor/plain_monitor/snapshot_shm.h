@@ -0,0 +1,95 @@
+#ifndef SNAPSHOT_SHM_H
+#define SNAPSHOT_SHM_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include "cpu_load_monitor.h"
+#include "disk_monitor.h"
+#include "mem_monitor.h"
+#include "psi_monitor.h"
+#include "numa_monitor.h"
+
+// 采集器 -> exporter 的共享内存快照通道
+// 守护进程把最新的 MemInfo/LoadAvgData/DiskStats/PsiTrigger/NodeStats 写入 /dev/shm 下的共享内存，
+// 每个区段由独立的 seqlock 保护；exporter 只需映射一次，之后读取不需要任何系统调用。
+// 布局（偏移和结构大小都记录在头部，读端据此校验）：
+//   SnapshotHeader | mem区段 | load区段 | disk区段 | psi区段 | numa区段
+// 每个区段以 SnapshotSeqlock 开头并按缓存行对齐，区段内容紧随其后。
+
+#define SNAPSHOT_SHM_NAME "/plain_monitor_snapshot"  // 对应 /dev/shm/plain_monitor_snapshot
+#define SNAPSHOT_MAGIC 0x4e534d50u                   // "PMSN"
+#define SNAPSHOT_VERSION 4
+#define SNAPSHOT_DEFAULT_DISKS 1024
+#define SNAPSHOT_ALIGN 64
+
+// seqlock：seq 为奇数表示正在写入，读端前后两次读到相同的偶数才算读到完整快照
+typedef struct {
+    _Atomic uint64_t seq;
+    uint64_t update_time_ns;    // 最近一次发布的时间（CLOCK_REALTIME，纳秒）
+} SnapshotSeqlock;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t region_size;       // 整个共享内存的字节数
+    uint32_t disk_capacity;     // disk 区段可容纳的设备数
+    uint32_t mem_offset;        // mem 区段偏移（指向 SnapshotSeqlock）
+    uint32_t mem_size;          // sizeof(MemInfo)
+    uint32_t load_offset;
+    uint32_t load_size;         // sizeof(LoadAvgData)
+    uint32_t disk_offset;
+    uint32_t disk_entry_size;   // sizeof(DiskStats)
+    uint32_t psi_offset;
+    uint32_t psi_entry_size;    // sizeof(PsiTrigger)，区段容量固定为 PSI_MAX_TRIGGERS
+    uint32_t numa_offset;
+    uint32_t numa_entry_size;   // sizeof(NodeStats)，区段容量固定为 NUMA_MAX_NODES
+    uint64_t writer_pid;        // 写端进程号
+} SnapshotHeader;
+
+// disk 区段在 seqlock 之后、DiskStats 数组之前的计数
+typedef struct {
+    uint32_t count;             // 本次发布的设备数
+    uint32_t dropped;           // 超出 disk_capacity 未能发布的设备数
+} SnapshotDiskCount;
+
+// psi 区段在 seqlock 之后、PsiTrigger 数组之前的计数
+typedef struct {
+    uint32_t count;             // 已注册的触发器数（含已失效的）
+    uint32_t capacity;          // PSI_MAX_TRIGGERS
+} SnapshotPsiCount;
+
+// numa 区段在 seqlock 之后、NodeStats 数组之前的计数
+typedef struct {
+    uint32_t count;             // 节点数
+    uint32_t capacity;          // NUMA_MAX_NODES
+} SnapshotNumaCount;
+
+// 共享内存句柄
+typedef struct {
+    void *base;
+    size_t size;
+    SnapshotHeader *header;
+} SnapshotShm;
+
+// 写端：新建共享内存对象并初始化头部，完成后原子地替换同名的旧对象（旧对象的已有映射不受影响）
+int snapshot_shm_create(SnapshotShm *shm, const char *name, uint32_t disk_capacity);
+
+// 在已有内存上初始化布局（用于基准测试等无需命名共享内存的场景）
+size_t snapshot_shm_region_size(uint32_t disk_capacity);
+void snapshot_shm_format(SnapshotShm *shm, void *base, size_t size, uint32_t disk_capacity);
+
+// 解除映射，unlink 非0时同时删除共享内存对象
+void snapshot_shm_close(SnapshotShm *shm, const char *name, int unlink);
+
+// 发布最新快照
+void snapshot_publish_meminfo(SnapshotShm *shm, const MemInfo *info);
+void snapshot_publish_loadavg(SnapshotShm *shm, const LoadAvgData *data);
+void snapshot_publish_disks(SnapshotShm *shm, const DiskRegistry *reg);
+void snapshot_publish_psi(SnapshotShm *shm, const PsiMonitor *mon);
+void snapshot_publish_numa(SnapshotShm *shm, const NumaRegistry *reg);
+
+// 读端（C 侧消费者与基准测试使用）：读到一致快照返回重试次数，max_retries 次仍失败返回-1
+int snapshot_read_meminfo(const SnapshotShm *shm, MemInfo *info, int max_retries);
+
+#endif // SNAPSHOT_SHM_H